@@ -0,0 +1,108 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Throughput of HTHash::hashBytes against std::hash<std::string> and FNV-1a, the hash
+// HTStringView used before HTHash, for inputs from 4 bytes to 1 MB. Build it with
+// -DHUTA_BUILD_BENCHMARKS=ON and run it on an otherwise idle machine.
+
+#include <Core/HTHash.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace Huta;
+
+static uint64_t hashFNV1a(const char* data, size_t length)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(size_t i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Hash size bytes iterations times and return GB/s. The start moves over 8 offsets so
+// that unaligned loads are measured too, the hashes are summed into sink so the calls
+// are not optimized away
+template <typename Hash>
+static double measure(const Hash& hash, size_t size, size_t iterations, uint64_t& sink)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        sink += hash(i & 7, size);
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(size) * iterations / 1e9 / seconds.count();
+}
+
+int main()
+{
+    const size_t sizes[] = { 4, 8, 16, 32, 64, 256, 1024, 4096, 65536, 1 << 20 };
+    const size_t largest = 1 << 20;
+
+    std::vector<char> bytes(largest + 8);
+    for(size_t i = 0; i < bytes.size(); ++i)
+    {
+        bytes[i] = static_cast<char>((i * 2654435761u) >> 13);
+    }
+
+    uint64_t sink = 0;
+    printf("%10s %12s %12s %12s\n", "size", "HTHash", "std::hash", "FNV-1a");
+    for(size_t size: sizes)
+    {
+        // About 256 MB per measurement, at most 20M calls for the small sizes
+        size_t iterations = std::min<size_t>((static_cast<size_t>(256) << 20) / size, 20000000);
+
+        double htHash = measure([&](size_t offset, size_t length)
+        {
+            return HTHash::hashBytes(bytes.data() + offset, length);
+        }, size, iterations, sink);
+
+        // std::hash only takes a string, change one of its bytes each call so the hash is
+        // not hoisted out of the loop
+        std::string string(bytes.data(), size);
+        std::hash<std::string> stringHash;
+        double stdHash = measure([&](size_t offset, size_t)
+        {
+            string[offset % size] ^= 1;
+            return static_cast<uint64_t>(stringHash(string));
+        }, size, iterations, sink);
+
+        double fnv = measure([&](size_t offset, size_t length)
+        {
+            return hashFNV1a(bytes.data() + offset, length);
+        }, size, iterations, sink);
+
+        printf("%8zu B %7.2f GB/s %7.2f GB/s %7.2f GB/s\n", size, htHash, stdHash, fnv);
+    }
+
+    // Print the sink so the compiler has to compute every hash
+    printf("(%llx)\n", static_cast<unsigned long long>(sink & 0xff));
+    return 0;
+}
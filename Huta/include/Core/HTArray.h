@@ -27,9 +27,12 @@
 
 #include <vector>
 #include <algorithm>
+#include <functional>
 
 NS_HT_BEGIN(Huta)
 
+class HTIndexSet;
+
 class HTArray: public HTObject, public HTClonable
 {
 public:
@@ -94,6 +97,12 @@ public:
     // Return the last element of the array
     HTRef* getLastObject();
 
+    // Return a new array with the elements at indexes, in ascending index order
+    HTArray* objectsAtIndexes(HTIndexSet* indexes);
+
+    // Return the indexes of the elements passing test, set *stop to true to end the test early
+    HTIndexSet* indexesOfObjectsPassingTest(const std::function<bool(HTRef* object, size_t index, bool* stop)>& test);
+
     // Return a bool value that indicates whether object is present in array
     bool containsObject(HTRef* object) const;
 
@@ -121,6 +130,9 @@ public:
     // Remove last object
     void removeLastObject();
 
+    // Remove the elements at indexes in one pass
+    void removeObjectsAtIndexes(HTIndexSet* indexes);
+
     // Swap two objects
     void swap(ssize_t indexOne, ssize_t indexTwo)
     {
@@ -132,6 +144,16 @@ public:
 
     iterator end() {return _data.end(); }
 
+    const_iterator begin() const { return _data.begin(); }
+
+    const_iterator end() const { return _data.end(); }
+
+protected:
+    // Write the elements as a list in describeTo
+    virtual HTDescriptionKind getDescriptionKind() const;
+
+    virtual void getDescriptionElements(std::vector<HTRef*>& elements) const;
+
 private:
     std::vector< HTRefPtr<HTRef> > _data;
 };
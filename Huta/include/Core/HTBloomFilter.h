@@ -0,0 +1,96 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+#include <Core/HTArray.h>
+#include <Core/HTSet.h>
+
+#include <vector>
+#include <cstdint>
+
+NS_HT_BEGIN(Huta)
+
+// Approximate membership filter. mightContainObject() never returns false for an
+// added object and returns true for other objects with about the configured false
+// positive rate, so it can rule out most misses before a lookup in a larger table.
+// Split block layout: a key sets one bit in each of the eight 32 bit words of a
+// single 256 bit block, so a probe reads one cache line and maps to SIMD lanes.
+class HTBloomFilter: public HTObject
+{
+public:
+    // Create an empty filter sized for expectedCount objects
+    static HTBloomFilter* createWithCapacity(size_t expectedCount, double falsePositiveRate);
+
+    // Create a filter with the objects of a set
+    static HTBloomFilter* createWithSet(HTSet* set, double falsePositiveRate);
+
+    // Create a filter with the objects of an array
+    static HTBloomFilter* createWithArray(HTArray* array, double falsePositiveRate);
+
+    // Create a filter from bytes returned by getBytes(). Return nullptr if the bytes are malformed
+    static HTBloomFilter* createWithBytes(const std::vector<unsigned char>& bytes);
+
+    HTBloomFilter();
+    ~HTBloomFilter();
+
+    // Initialize the filter. Return true if initialization is successful
+    bool initWithCapacity(size_t expectedCount, double falsePositiveRate);
+
+    // Add an object using its hash(). Strings, slices and data use a fixed seed instead of
+    // the process seed, see HTHash
+    void addObject(HTRef* object);
+
+    // Add a precomputed hash
+    void addHash(size_t hash);
+
+    // Return false if object was certainly not added
+    bool mightContainObject(HTRef* object) const;
+
+    // Return false if hash was certainly not added
+    bool mightContainHash(size_t hash) const;
+
+    // Add all objects of other filter, for example one filled by another thread.
+    // Both filters must have the same size. Return false if they don't
+    bool mergeFilter(HTBloomFilter* other);
+
+    // Remove all objects
+    void removeAllObjects();
+
+    // Get the size of the filter in bytes
+    size_t getByteSize() const;
+
+    // Serialize the filter. Strings, slices, data and numbers hash the same in every process,
+    // objects compared by identity only make sense in the process that added them
+    std::vector<unsigned char> getBytes() const;
+
+private:
+    size_t blockOf(uint64_t hash) const;
+
+    // 8 words of 32 bits per block
+    std::vector<uint32_t> _words;
+    size_t _blockCount;
+};
+
+NS_HT_END(Huta)
@@ -0,0 +1,105 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+NS_HT_BEGIN(Huta)
+
+struct HTCacheShard;
+
+// Thread safe key-value cache with least recently used eviction. Keys are split
+// into shards by hash, each shard has its own lock, its own recency list and an
+// equal part of the limits. The limits are applied per shard, so eviction is only
+// approximately least recently used across the whole cache and a shard can evict while
+// others still have room. A small count limit uses fewer shards, so that each shard
+// holds at least 8 entries. Evicted objects are released by the cache only, an
+// HTRefPtr returned by objectForKey() keeps an object alive after its eviction.
+class HTCache: public HTObject
+{
+public:
+    // Called for each evicted entry, outside of the shard lock
+    typedef std::function<void(HTRef* key, HTRef* object)> EvictionCallback;
+
+    // Create a cache without limits and with one shard per hardware thread
+    static HTCache* create();
+
+    // Create a cache with limits on the entry count and the total cost, 0 means no limit.
+    // Pass 0 as shardCount to use one shard per hardware thread. The shard count is rounded
+    // up to a power of two, then lowered while countLimit gives a shard fewer than 8 entries
+    static HTCache* createWithLimits(size_t countLimit, size_t costLimit, size_t shardCount);
+
+    HTCache();
+    ~HTCache();
+
+    // Initialize the cache. Return true if initialization is successful
+    bool initWithLimits(size_t countLimit, size_t costLimit, size_t shardCount);
+
+    // Get the object for key and mark it as recently used, nullptr if there is none
+    HTRefPtr<HTRef> objectForKey(HTRef* key);
+
+    // Insert an object with cost 0
+    void setObject(HTRef* object, HTRef* key);
+
+    // Insert an object with a cost, for example its size in bytes
+    void setObject(HTRef* object, HTRef* key, size_t cost);
+
+    // Remove an object by the specified key. The eviction callback is not called
+    void removeObjectForKey(HTRef* key);
+
+    // Remove all objects. The eviction callback is not called
+    void removeAllObjects();
+
+    // Set the callback called for entries evicted because of the limits
+    void setEvictionCallback(const EvictionCallback& callback);
+
+    // Get the count of entries
+    size_t count() const;
+
+    // Get the sum of entry costs
+    size_t totalCost() const;
+
+    // Get how many lookups found an object
+    uint64_t hitCount() const;
+
+    // Get how many lookups found nothing
+    uint64_t missCount() const;
+
+    // Get how many entries were evicted because of the limits
+    uint64_t evictionCount() const;
+
+private:
+    HTCacheShard& shardForKey(HTRef* key);
+
+    std::vector< std::unique_ptr<HTCacheShard> > _shards;
+    unsigned int _shardShift;
+    EvictionCallback _evictionCallback;
+};
+
+NS_HT_END(Huta)
@@ -0,0 +1,123 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+#include <Core/HTArray.h>
+
+#include <vector>
+#include <functional>
+
+NS_HT_BEGIN(Huta)
+
+// Unordered collection of distinct objects, each with the number of times it was added.
+// Counts are stored next to the objects in a flat open addressing table, so counting
+// an object that is already present doesn't allocate.
+class HTCountedSet: public HTObject
+{
+public:
+    HTCountedSet();
+    ~HTCountedSet();
+
+    // Create an empty counted set
+    static HTCountedSet* create();
+
+    // Create an empty counted set with room for capacity distinct objects
+    static HTCountedSet* createWithCapacity(size_t capacity);
+
+    // Merge counted sets, for example counters filled by several threads. The objects are
+    // partitioned by hash and each partition is merged on its own thread.
+    // Pass 0 as threadCount to use one thread per hardware thread
+    static HTCountedSet* createByMergingCountedSets(const std::vector<HTCountedSet*>& sets, size_t threadCount);
+
+    // Return count of distinct objects
+    size_t count() const;
+
+    // Return sum of all counts
+    size_t totalCount() const;
+
+    // Add a certain object once
+    void addObject(HTObject* object);
+
+    // Add a certain object a number of times
+    void addObject(HTObject* object, size_t times);
+
+    // Remove a certain object once. The object leaves the set when its count reaches 0
+    void removeObject(HTObject* object);
+
+    // Remove all objects
+    void removeAllObjects();
+
+    // Return how many times an object equal to object was added, 0 if none
+    size_t countForObject(HTObject* object) const;
+
+    // Return a bool value that indicates whether object is present in set
+    bool containsObject(HTObject* object) const;
+
+    // Add the counts of other counted set
+    void unionCountedSet(HTCountedSet* other);
+
+    // Return up to k objects with the highest counts, highest first
+    HTArray* topObjects(size_t k) const;
+
+    // Return all distinct objects
+    HTArray* allObjects() const;
+
+    // Call back for each object and its count, set *stop to true to end the enumeration early
+    void enumerateObjectsAndCounts(const std::function<void(HTRef* object, size_t count, bool* stop)>& callback) const;
+
+protected:
+    // Write the elements as a set in describeTo
+    virtual HTDescriptionKind getDescriptionKind() const;
+
+    virtual void getDescriptionElements(std::vector<HTRef*>& elements) const;
+
+private:
+    struct Slot
+    {
+        size_t hash;
+        HTObject* object;
+        size_t count;
+    };
+
+    // Open addressing table indexed by the high bits of the hash. It doesn't retain objects
+    struct Table
+    {
+        Table();
+
+        Slot* find(size_t hash, const HTObject* object) const;
+        Slot* findOrInsert(size_t hash, HTObject* object, bool& inserted);
+        void erase(Slot* slot);
+        void reserve(size_t count);
+
+        std::vector<Slot> slots;
+        size_t count;
+        unsigned int shift;
+    };
+
+    Table _table;
+    size_t _totalCount;
+};
+
+NS_HT_END(Huta)
@@ -0,0 +1,137 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+#include <Core/HTStringView.h>
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+NS_HT_BEGIN(Huta)
+
+// Immutable contiguous bytes. The bytes are either copied in, adopted from a buffer the
+// caller allocated, borrowed from storage the caller keeps alive, or mapped from a file.
+// Slices share the bytes of the data they come from and retain it, so cutting a mapped
+// file into records never copies anything. A mapped file must not be shortened while the
+// data lives: reading the missing pages kills the process with SIGBUS.
+class HTData: public HTObject
+{
+public:
+    // Called with the bytes and the length once the data is destroyed
+    typedef std::function<void(void* bytes, size_t length)> Deallocator;
+
+    // Create an empty data
+    static HTData* create();
+
+    // Create a data with a copy of length bytes
+    static HTData* createWithBytes(const void* bytes, size_t length);
+
+    // Create a data that takes over bytes without copying. If freeWhenDone is true the
+    // bytes must come from malloc and are freed with the data, otherwise they are only
+    // borrowed and must outlive it
+    static HTData* createWithBytesNoCopy(void* bytes, size_t length, bool freeWhenDone = true);
+
+    // Create a data that takes over bytes and hands them to deallocator once destroyed
+    static HTData* createWithDeallocator(void* bytes, size_t length, const Deallocator& deallocator);
+
+    // Create a data with the contents of a file. If mapped is true the file is mapped into
+    // memory and pages are read on first access, otherwise it is read into one buffer.
+    // Files that can not be mapped, like pipes, are read. Return nullptr if the file can not
+    // be opened or read
+    static HTData* createWithContentsOfFile(const std::string& path, bool mapped = true);
+
+    HTData();
+    ~HTData();
+
+    bool initWithBytes(const void* bytes, size_t length);
+
+    bool initWithBytesNoCopy(void* bytes, size_t length, const Deallocator& deallocator);
+
+    bool initWithContentsOfFile(const std::string& path, bool mapped);
+
+    // Get the bytes. Valid while the data lives
+    const unsigned char* getBytes() const
+    {
+        return _bytes;
+    }
+
+    // Get the count of bytes
+    size_t length() const
+    {
+        return _length;
+    }
+
+    // Return true if the data has no bytes
+    bool isEmpty() const
+    {
+        return _length == 0;
+    }
+
+    // Return true if the bytes are mapped from a file, directly or through a parent
+    bool isMapped() const;
+
+    // Get the data this one is a slice of, nullptr if it owns or borrows its bytes itself
+    HTData* getParent() const
+    {
+        return _parent;
+    }
+
+    // Get the bytes as characters, for searching and splitting text without a copy
+    HTStringView getView() const
+    {
+        return HTStringView(reinterpret_cast<const char*>(_bytes), _length);
+    }
+
+    // Get the byte at index. Throw an exception if index is out of range
+    unsigned char byteAtIndex(size_t index) const;
+
+    // Create a data of length bytes at offset that shares these bytes. Throw an exception
+    // if the range is out of bounds
+    HTData* subdataWithRange(size_t offset, size_t length) const;
+
+    // Return true if other has the same bytes
+    bool isEqualToData(const HTData* other) const;
+
+    // Equal to data with the same bytes
+    virtual bool isEqual(const HTObject* object);
+
+    // Seeded hash of all the bytes, computed once
+    virtual size_t hash() const;
+
+protected:
+    // Write the length, never the bytes
+    virtual void describeSelfTo(HTOutputSink& sink) const;
+
+private:
+    const unsigned char* _bytes;
+    size_t _length;
+    HTData* _parent;
+    Deallocator _deallocator;
+    bool _mapped;
+    mutable std::atomic<size_t> _hash;
+    mutable std::atomic<bool> _hasHash;
+};
+
+NS_HT_END(Huta)
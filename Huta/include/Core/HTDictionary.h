@@ -27,7 +27,7 @@
 #include <Core/HTArray.h>
 #include <unordered_map>
 #include <functional>
-#include <sstream>
+#include <iterator>
 
 NS_HT_BEGIN(Huta)
 
@@ -37,7 +37,78 @@ class HTDictionaryElement;
 
 class HTDictionary: public HTObject, public HTClonable
 {
+private:
+    
+    // Keys are compared with hash() and isEqual(), like the keys of HTSet
+    struct KeyHasher
+    {
+        size_t operator()(const HTRefPtr<HTRef>& key) const
+        {
+            return HTRefHasher()(key.get());
+        }
+    };
+
+    struct KeyEqual
+    {
+        bool operator()(const HTRefPtr<HTRef>& key, const HTRefPtr<HTRef>& other) const
+        {
+            return HTRefEqual()(key.get(), other.get());
+        }
+    };
+
+    typedef std::unordered_map<HTRefPtr<HTRef>, HTRefPtr<HTRef>, KeyHasher, KeyEqual> Map;
+
 public:
+
+    typedef Map::const_iterator const_iterator;
+
+    // Iterator over the keys or the objects of a dictionary
+    template <bool Keys>
+    class ViewIterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef HTRef* value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef HTRef* const* pointer;
+        typedef HTRef* reference;
+
+        explicit ViewIterator(const_iterator it): _it(it) {}
+
+        HTRef* operator*() const { return Keys ? _it->first.get() : _it->second.get(); }
+
+        ViewIterator& operator++() { ++_it; return *this; }
+
+        ViewIterator operator++(int) { ViewIterator tmp(*this); ++_it; return tmp; }
+
+        bool operator==(const ViewIterator& other) const { return _it == other._it; }
+
+        bool operator!=(const ViewIterator& other) const { return _it != other._it; }
+
+    private:
+        const_iterator _it;
+    };
+
+    // Lightweight range over the keys or the objects, valid until the dictionary is modified
+    template <bool Keys>
+    class View
+    {
+    public:
+        explicit View(const HTDictionary* dictionary): _dictionary(dictionary) {}
+
+        ViewIterator<Keys> begin() const { return ViewIterator<Keys>(_dictionary->begin()); }
+
+        ViewIterator<Keys> end() const { return ViewIterator<Keys>(_dictionary->end()); }
+
+        size_t size() const { return _dictionary->count(); }
+
+    private:
+        const HTDictionary* _dictionary;
+    };
+
+    typedef View<true> KeyView;
+    typedef View<false> ObjectView;
+
     // Create an empty dictionary
     static HTDictionary* create();
 
@@ -51,18 +122,34 @@ public:
     bool init();
 
     // Get the count of elements in Dictionary
-    size_t count();
+    size_t count() const;
 
-    // Return all keys of elements
+    // Return all keys of elements. Use keys() or enumerateKeysAndObjects() to only iterate
     HTArray* allKeys();
 
-    // Return all values of elements
+    // Return all values of elements. Use objects() or enumerateKeysAndObjects() to only iterate
     HTArray* allObjects();
 
+    // Iterate over keys without retaining them
+    KeyView keys() const { return KeyView(this); }
+
+    // Iterate over values without retaining them
+    ObjectView objects() const { return ObjectView(this); }
+
+    // Call back for each entry, set *stop to true to end the enumeration early
+    void enumerateKeysAndObjects(const std::function<void(HTRef* key, HTRef* object, bool* stop)>& callback) const;
+
+    const_iterator begin() const { return _map.begin(); }
+
+    const_iterator end() const { return _map.end(); }
+
     // Get the object according to the specified key
     HTRef* objectForKey(HTRef* key);
 
-    // Insert an object to dictionary, and match it with the specified key
+    // Insert an object to dictionary, and match it with the specified key. Keys are compared
+    // by value, so an HTString key is copied and changing the caller's string afterwards does
+    // not affect the entry. Other keys must not change in a way that changes hash() or
+    // isEqual() while they are in the dictionary
     void setObject(HTRef* object, HTRef* key);
 
     // Remove an object by the specified key
@@ -77,21 +164,14 @@ public:
     // Clone object
     HTDictionary* clone() const override;
 
-private:
-    
-    struct KeyHasher
-    {
-        std::size_t operator()(const HTRefPtr<HTRef>& key) const
-        {
-            std::stringstream ss;
-            ss << key.get();
+protected:
+    // Write the elements as a map in describeTo
+    virtual HTDescriptionKind getDescriptionKind() const;
 
-            std::hash<std::string> hash;
-            std::cout << key.get() << " " <<  hash(ss.str()) << std::endl;
-            return hash(ss.str());
-        }
-    };
-    std::unordered_map<HTRefPtr<HTRef>, HTRefPtr<HTRef>, KeyHasher> _map;
+    virtual void getDescriptionElements(std::vector<HTRef*>& elements) const;
+
+private:
+    Map _map;
 };
 
 NS_HT_END(Huta)
\ No newline at end of file
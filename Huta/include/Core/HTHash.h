@@ -0,0 +1,76 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#pragma once
+
+#include <Core/HTMacros.h>
+
+#include <cstddef>
+#include <cstdint>
+
+NS_HT_BEGIN(Huta)
+
+// 64 bit hashing of bytes and integers. hashBytes is a wyhash style function: inputs up
+// to 16 bytes take one or two loads and a single 128 bit multiply, longer ones are read
+// 48 bytes at a time in three independent lanes. The same seed always gives the same
+// hash, which is fine for data the program controls. Keys that come from outside should
+// be hashed with hashBytesSeeded, whose seed is random per process so that nobody can
+// prepare keys that all collide. Set HUTA_HASH_SEED in the environment to a number to
+// fix that seed, for example to reproduce a run.
+class HTHash
+{
+public:
+    // Hash bytes with an explicit seed
+    static uint64_t hashBytes(const void* data, size_t length, uint64_t seed = 0);
+
+    // Hash bytes with the process seed
+    static uint64_t hashBytesSeeded(const void* data, size_t length)
+    {
+        return hashBytes(data, length, getProcessSeed());
+    }
+
+    // Get the seed of hashBytesSeeded. It is picked once, on first use
+    static uint64_t getProcessSeed();
+
+    // Scramble an integer so that every input bit changes about half of the output bits.
+    // Use it on weak hashes before taking some of their bits
+    static uint64_t mix(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    // Fold value into the hash seed, for hashing objects made of several parts. The order
+    // of the parts matters
+    static uint64_t combine(uint64_t seed, uint64_t value)
+    {
+        return mix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+    }
+
+private:
+    HTHash() = delete;
+};
+
+NS_HT_END(Huta)
@@ -0,0 +1,124 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+
+#include <vector>
+#include <functional>
+
+NS_HT_BEGIN(Huta)
+
+class HTArray;
+
+// Priority queue kept as a 4-ary heap in one contiguous vector. A node's four
+// children are adjacent, so a sift down compares one cache line of pointers per
+// level and the tree is half as deep as a binary heap. Each pushed object gets a
+// handle that stays valid until the object leaves the heap, it is used to reorder
+// the object after its priority changed or to remove it.
+class HTHeap: public HTObject
+{
+public:
+    // Return true if a must leave the heap before b
+    typedef std::function<bool(HTRef* a, HTRef* b)> Comparator;
+
+    typedef size_t Handle;
+
+    // Create an empty heap ordered by comparator
+    static HTHeap* createWithComparator(const Comparator& comparator);
+
+    // Create a heap from the elements of an array in linear time
+    static HTHeap* createWithArray(HTArray* array, const Comparator& comparator);
+
+    HTHeap();
+    ~HTHeap();
+
+    // Initialize an empty heap
+    bool initWithComparator(const Comparator& comparator);
+
+    // Initialize a heap with the elements of an array
+    bool initWithArray(HTArray* array, const Comparator& comparator);
+
+    // Get the count of objects
+    size_t count() const
+    {
+        return _nodes.size();
+    }
+
+    // Add an object and return its handle
+    Handle push(HTRef* object);
+
+    // Get the first object without removing it, nullptr if the heap is empty
+    HTRef* peek() const;
+
+    // Remove the first object and return it, nullptr if the heap is empty
+    HTRefPtr<HTRef> pop();
+
+    // Get the object of a handle
+    HTRef* getObjectForHandle(Handle handle) const;
+
+    // Return true if the object of a handle is still in the heap
+    bool containsHandle(Handle handle) const;
+
+    // Restore the order after the priority of the object of a handle changed, in either direction
+    void updateObject(Handle handle);
+
+    // Put another object in place of the object of a handle, the handle stays valid
+    void replaceObject(Handle handle, HTRef* object);
+
+    // Remove the object of a handle
+    void removeObject(Handle handle);
+
+    // Remove all objects, every handle becomes invalid
+    void removeAllObjects();
+
+    // Get all objects in heap order, the first one comes first
+    HTArray* allObjects() const;
+
+private:
+    struct Node
+    {
+        HTRefPtr<HTRef> object;
+        Handle handle;
+    };
+
+    static const size_t kArity = 4;
+    static const size_t kNoPosition = static_cast<size_t>(-1);
+
+    size_t positionOfHandle(Handle handle) const;
+    Handle acquireHandle();
+    void place(Node& node, size_t position);
+    void siftUp(size_t position);
+    void siftDown(size_t position);
+    void heapify();
+    void removeAtPosition(size_t position);
+
+    Comparator _comparator;
+    std::vector<Node> _nodes;
+    // Heap position of every handle, kNoPosition for released handles
+    std::vector<size_t> _positions;
+    std::vector<Handle> _freeHandles;
+};
+
+NS_HT_END(Huta)
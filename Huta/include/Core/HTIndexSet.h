@@ -0,0 +1,127 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+NS_HT_BEGIN(Huta)
+
+// Set of indexes stored as a compressed bitmap. Indexes are grouped by their high
+// bits into chunks of 65536, each chunk is kept as a sorted array, a plain bitmap or
+// a list of runs, whichever is smallest. Sparse and range shaped selections over
+// large arrays need a few bytes per chunk instead of a word per index.
+class HTIndexSet: public HTObject
+{
+public:
+    // Create an empty index set
+    static HTIndexSet* create();
+
+    // Create an index set with one index
+    static HTIndexSet* createWithIndex(size_t index);
+
+    // Create an index set with the indexes location to location + length - 1
+    static HTIndexSet* createWithIndexesInRange(size_t location, size_t length);
+
+    HTIndexSet();
+    HTIndexSet(const HTIndexSet& other);
+    ~HTIndexSet();
+
+    // Return count of indexes
+    size_t count() const;
+
+    // Return a bool value that indicates whether index is present in set
+    bool containsIndex(size_t index) const;
+
+    // Return the smallest index, -1 if set is empty
+    ssize_t firstIndex() const;
+
+    // Return the largest index, -1 if set is empty
+    ssize_t lastIndex() const;
+
+    // Add an index. Adding in ascending order is the fastest
+    void addIndex(size_t index);
+
+    // Add the indexes location to location + length - 1
+    void addIndexesInRange(size_t location, size_t length);
+
+    // Remove an index
+    void removeIndex(size_t index);
+
+    // Remove all indexes
+    void removeAllIndexes();
+
+    // Add each index of other set
+    void unionIndexSet(HTIndexSet* other);
+
+    // Remove each index which is not present in other set
+    void intersectIndexSet(HTIndexSet* other);
+
+    // Call back for each index in ascending order, set *stop to true to end the enumeration early
+    void enumerateIndexes(const std::function<void(size_t index, bool* stop)>& callback) const;
+
+    // Return the memory used by the indexes in bytes
+    size_t getByteSize() const;
+
+private:
+    struct Container
+    {
+        enum Type { kArray, kBitmap, kRun };
+
+        Container();
+
+        bool contains(uint16_t value) const;
+        bool add(uint16_t value);
+        bool remove(uint16_t value);
+        void addRange(uint32_t first, uint32_t last);
+        void unite(const Container& other);
+        void intersect(const Container& other);
+        uint16_t minimum() const;
+        uint16_t maximum() const;
+        bool enumerate(size_t base, const std::function<void(size_t index, bool* stop)>& callback) const;
+        size_t byteSize() const;
+
+        void toBitmap();
+        void optimize();
+        void optimizeRuns();
+        void countBits();
+
+        Type type;
+        uint32_t cardinality;
+        // Sorted values of an array container, start and length - 1 pairs of a run container
+        std::vector<uint16_t> values;
+        // 1024 words of a bitmap container
+        std::vector<uint64_t> bits;
+    };
+
+    Container& containerForKey(size_t key);
+
+    std::vector<size_t> _keys;
+    std::vector<Container> _containers;
+};
+
+NS_HT_END(Huta)
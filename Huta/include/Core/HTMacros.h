@@ -133,3 +133,13 @@ public: virtual void set##funName(varType var)   \
         #define HT_REQUIRES_NULL_TERMINATION
     #endif
 #endif
+
+// printf style format checking. Positions count from 1, the implicit this of a member
+// function is the first parameter
+#ifndef HT_FORMAT_PRINTF
+    #if defined(__GNUC__)
+        #define HT_FORMAT_PRINTF(formatPosition, argumentPosition) __attribute__((format(printf, formatPosition, argumentPosition)))
+    #else
+        #define HT_FORMAT_PRINTF(formatPosition, argumentPosition)
+    #endif
+#endif
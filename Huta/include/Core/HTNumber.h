@@ -0,0 +1,110 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+
+#include <cstdint>
+
+NS_HT_BEGIN(Huta)
+
+// Immutable boxed int64, double or bool. Booleans, integers from -128 to 1023 and
+// doubles holding those integers are shared immortal instances: creating them does
+// not allocate and retaining or releasing them does not touch a reference count.
+// Numbers compare by value across types, 2 is equal to 2.0 and true is equal to 1.
+class HTNumber: public HTObject
+{
+public:
+    enum Type
+    {
+        kBool,
+        kInt64,
+        kDouble
+    };
+
+    // Create a number with an integer value
+    static HTNumber* createWithInt(int64_t value);
+
+    // Create a number with a double value
+    static HTNumber* createWithDouble(double value);
+
+    // Create a number with a bool value
+    static HTNumber* createWithBool(bool value);
+
+    // Get the type the number was created with
+    Type getType() const
+    {
+        return _type;
+    }
+
+    // Convert to int64 value, doubles are converted with int64FromDouble
+    int64_t int64Value() const;
+
+    // Convert to int value
+    int intValue() const
+    {
+        return static_cast<int>(int64Value());
+    }
+
+    // Convert to double value
+    double doubleValue() const;
+
+    // Convert to bool value, any non zero number is true
+    bool boolValue() const;
+
+    // Compare by value. Return a negative value, 0 or a positive value
+    int compare(const HTNumber* other) const;
+
+    virtual bool isEqual(const HTObject* other);
+
+    virtual size_t hash() const;
+
+    virtual HTString* toString() const;
+
+    // Convert a double to int64, truncated toward zero. NaN becomes 0, values outside the
+    // int64 range including the infinities saturate to INT64_MIN or INT64_MAX
+    static int64_t int64FromDouble(double value);
+
+protected:
+    // Write the value like toString()
+    virtual void describeSelfTo(HTOutputSink& sink) const;
+
+    HTNumber();
+    ~HTNumber();
+
+private:
+    friend struct HTNumberCache;
+
+    // Return the integer held by the number if it has an exact one
+    bool exactInt64(int64_t& value) const;
+
+    Type _type;
+    union
+    {
+        int64_t _int;
+        double _double;
+    };
+};
+
+NS_HT_END(Huta)
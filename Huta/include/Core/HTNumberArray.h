@@ -0,0 +1,179 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+#include <Core/HTStringView.h>
+
+#include <vector>
+#include <cstdint>
+
+NS_HT_BEGIN(Huta)
+
+class HTArray;
+class HTStringArray;
+
+// Contiguous array of unboxed int64 or double values. Reductions run over the raw
+// buffer with several independent accumulators, 256 bit vectors when AVX2 is enabled
+// at compile time, so they are bound by memory bandwidth rather than by one add chain.
+// Double sums are therefore added in a different order than a plain loop would use.
+// Wherever a double becomes an int64 it goes through HTNumber::int64FromDouble, so it is
+// truncated toward zero, NaN becomes 0 and values out of the int64 range saturate.
+class HTNumberArray: public HTObject
+{
+public:
+    enum Type
+    {
+        kInt64,
+        kDouble
+    };
+
+    enum Comparison
+    {
+        kLess,
+        kLessOrEqual,
+        kEqual,
+        kNotEqual,
+        kGreaterOrEqual,
+        kGreater
+    };
+
+    // Create an empty array of a type
+    static HTNumberArray* createWithType(Type type);
+
+    // Create an empty array of a type with capacity
+    static HTNumberArray* createWithCapacity(Type type, size_t capacity);
+
+    // Create an int64 array by copying values
+    static HTNumberArray* createWithInt64Values(const int64_t* values, size_t count);
+
+    // Create a double array by copying values
+    static HTNumberArray* createWithDoubleValues(const double* values, size_t count);
+
+    // Create an array from an array of HTNumber, values are converted to type
+    static HTNumberArray* createWithArray(HTArray* array, Type type);
+
+    // Create an array of type by parsing every string, see HTNumberParser. Return nullptr
+    // if a string is not a numeral of type, and its index in errorIndex when it is not nullptr
+    static HTNumberArray* createByParsingStrings(HTStringArray* strings, Type type, size_t* errorIndex = nullptr);
+
+    // Create an array of type by parsing an array of HTString or HTStringSlice. Return
+    // nullptr if an element is not a numeral of type, and its index in errorIndex when it is not nullptr
+    static HTNumberArray* createByParsingArray(HTArray* array, Type type, size_t* errorIndex = nullptr);
+
+    HTNumberArray();
+    ~HTNumberArray();
+
+    // Initialize an empty array of a type with capacity
+    bool initWithCapacity(Type type, size_t capacity);
+
+    // Get the type of the values
+    Type getType() const
+    {
+        return _type;
+    }
+
+    // Return value count of the array
+    size_t count() const
+    {
+        return _type == kInt64 ? _ints.size() : _doubles.size();
+    }
+
+    // Get the values of an int64 array, nullptr for a double array
+    const int64_t* getInt64Values() const;
+
+    // Get the values of a double array, nullptr for an int64 array
+    const double* getDoubleValues() const;
+
+    // Return the value at index converted to int64, saturated like HTNumber::int64FromDouble
+    int64_t int64ValueAtIndex(size_t index) const;
+
+    // Return the value at index converted to double
+    double doubleValueAtIndex(size_t index) const;
+
+    // Add a value, it is converted to the type of the array
+    void addInt64Value(int64_t value);
+
+    // Add a value, it is converted to the type of the array
+    void addDoubleValue(double value);
+
+    // Add all values of an array, they are converted to the type of the array
+    void addValuesFromArray(HTNumberArray* other);
+
+    // Set the value at index, it is converted to the type of the array
+    void setDoubleValue(double value, size_t index);
+
+    // Set the value at index, it is converted to the type of the array
+    void setInt64Value(int64_t value, size_t index);
+
+    // Remove all values
+    void removeAllValues();
+
+    // Sum of the values. An int64 sum wraps around on overflow, a double sum saturates
+    int64_t int64Sum() const;
+
+    // Sum of the values as double
+    double sum() const;
+
+    // Smallest value converted to double. Throw HTException if the array is empty
+    double min() const;
+
+    // Largest value converted to double. Throw HTException if the array is empty
+    double max() const;
+
+    // Smallest value of an int64 array. Throw HTException if the array is empty
+    int64_t int64Min() const;
+
+    // Largest value of an int64 array. Throw HTException if the array is empty
+    int64_t int64Max() const;
+
+    // Arithmetic mean. Throw HTException if the array is empty
+    double mean() const;
+
+    // Sum of the products of values at the same index. Throw HTException if the counts differ
+    double dot(HTNumberArray* other) const;
+
+    // Count the values v for which "v comparison value" is true
+    size_t countIf(Comparison comparison, double value) const;
+
+    // Sort the values ascending, NaN values go last
+    void sort();
+
+    // Get the values as an array of HTNumber
+    HTArray* toArray() const;
+
+protected:
+    // Write the values as a list. They are values rather than objects, so the array is a leaf
+    virtual void describeSelfTo(HTOutputSink& sink) const;
+
+private:
+    // Parse view and add the value. Return false if it is not a numeral of the array type
+    bool addParsedValue(const HTStringView& view);
+
+    Type _type;
+    std::vector<int64_t> _ints;
+    std::vector<double> _doubles;
+};
+
+NS_HT_END(Huta)
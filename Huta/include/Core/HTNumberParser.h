@@ -0,0 +1,132 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTStringView.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+NS_HT_BEGIN(Huta)
+
+// Outcome of parsing a numeral
+enum HTParseStatus
+{
+    kHTParseSuccess,
+    // No numeral at the start, or characters after it where the whole text had to be one
+    kHTParseInvalid,
+    // A numeral whose value does not fit the type
+    kHTParseOutOfRange
+};
+
+// End of the numeral and outcome, like std::from_chars_result. end is the start of the
+// text when it does not begin with a numeral
+struct HTParseResult
+{
+    const char* end;
+    HTParseStatus status;
+};
+
+// Numeral parsing in the manner of std::from_chars: no exceptions, no leading white space
+// or plus sign, and the decimal point is always '.'. Integers are decimal with an optional
+// minus sign for signed types. Floating point numerals are [-]digits[.digits][e[+-]digits],
+// inf, infinity or nan in any case; hexadecimal is not accepted, so "0x10" stops after the
+// 0. Values that overflow or underflow to zero or a subnormal are kHTParseOutOfRange. The
+// value is only written on success.
+//
+// Eight digits at a time are checked and converted with 64 bit arithmetic. Floating point
+// numerals with up to 15 significant digits and a small exponent are exact with a single
+// multiplication or division, longer ones go through strtod. That path reads the decimal
+// point of the current locale with localeconv(), so it must not run while another thread
+// calls setlocale.
+class HTNumberParser
+{
+public:
+    static HTParseResult parse(const char* first, const char* last, int& value);
+
+    static HTParseResult parse(const char* first, const char* last, unsigned int& value);
+
+    static HTParseResult parse(const char* first, const char* last, int64_t& value);
+
+    static HTParseResult parse(const char* first, const char* last, uint64_t& value);
+
+    static HTParseResult parse(const char* first, const char* last, float& value);
+
+    static HTParseResult parse(const char* first, const char* last, double& value);
+
+    // Parse all of view. Characters after the numeral make it kHTParseInvalid
+    template<typename T>
+    static HTParseStatus parseAll(const HTStringView& view, T& value)
+    {
+        const char* last = view.data + view.length;
+        T parsed;
+        HTParseResult result = parse(view.data, last, parsed);
+        if(result.status != kHTParseSuccess)
+        {
+            return result.status;
+        }
+        if(result.end != last)
+        {
+            return kHTParseInvalid;
+        }
+        value = parsed;
+        return kHTParseSuccess;
+    }
+
+    // Parse the numeral at the start of view the way std::stoi and std::stod do, for the
+    // throwing value getters of HTString. White space and a plus sign before the numeral are
+    // skipped and characters after it are ignored. Throw std::invalid_argument or
+    // std::out_of_range with name as message
+    template<typename T>
+    static T parseLeading(const HTStringView& view, const char* name)
+    {
+        const char* first = view.data;
+        const char* last = view.data + view.length;
+        while(first < last && (*first == ' ' || (*first >= '\t' && *first <= '\r')))
+        {
+            ++first;
+        }
+        if(first < last && *first == '+' && (last - first < 2 || first[1] != '-'))
+        {
+            ++first;
+        }
+
+        T value;
+        HTParseResult result = parse(first, last, value);
+        if(result.status == kHTParseInvalid)
+        {
+            throw std::invalid_argument(name);
+        }
+        if(result.status == kHTParseOutOfRange)
+        {
+            throw std::out_of_range(name);
+        }
+        return value;
+    }
+
+private:
+    HTNumberParser() = delete;
+};
+
+NS_HT_END(Huta)
@@ -24,9 +24,22 @@
 #include <Core/HTMacros.h>
 #include <Core/HTRef.h>
 
+#include <atomic>
+#include <vector>
+
 NS_HT_BEGIN(Huta)
 
 class HTString;
+class HTOutputSink;
+
+// How describeTo writes the elements of an object
+enum HTDescriptionKind
+{
+    kHTDescriptionLeaf,     // Not a container, describeSelfTo writes everything
+    kHTDescriptionList,     // [a, b]
+    kHTDescriptionSet,      // {a, b}
+    kHTDescriptionMap       // {key: object, key: object}
+};
 
 class HTClonable {
 public:
@@ -63,19 +76,66 @@ public:
     // Compare two objects
     virtual bool isEqual(const HTObject* object);
 
-    // Object description
+    // Hash value of object. Objects that are equal must return the same hash
+    virtual size_t hash() const;
+
+    // Object description, written by describeTo
     virtual HTString* toString() const;
+
+    // Write the description of the object and of everything it holds into sink. Containers
+    // are walked with an explicit stack instead of recursion. Containers nested deeper than
+    // maxDepth are written as [...], a container inside itself as (cycle)
+    void describeTo(HTOutputSink& sink, size_t maxDepth = kDefaultDescriptionDepth) const;
+
+    static const size_t kDefaultDescriptionDepth = 64;
 public:
     HTObject();
 protected:
     virtual ~HTObject();
+
+    // Write the description of a leaf. The default writes the address
+    virtual void describeSelfTo(HTOutputSink& sink) const;
+
+    // Containers return how their elements are written
+    virtual HTDescriptionKind getDescriptionKind() const;
+
+    // Containers append their elements, a map each key followed by its object
+    virtual void getDescriptionElements(std::vector<HTRef*>& elements) const;
+
+    // Keep the object for the lifetime of the process. Retain, release and autorelease
+    // stop touching the reference count, so shared constant instances cost no atomic
+    // traffic and never bounce between cores
+    void makeImmortal();
+
+    // Return true if the object was made immortal
+    bool isImmortal() const
+    {
+        return _referenceCount.load(std::memory_order_relaxed) >= kImmortalReferenceCount;
+    }
+
 #ifdef HT_MEM_LEAK_TRACK
     static void printLeaks();
 #endif
 
 protected:
-    unsigned int _referenceCount;
+    // Counts at or above this value mark an immortal object
+    static const unsigned int kImmortalReferenceCount = 0x80000000u;
+
+    // Atomic so that objects can be shared between threads
+    std::atomic<unsigned int> _referenceCount;
     friend class HTAutoreleasePool;
 };
 
+// Hash functor for HTRef keys. Uses hash() of HTObject, address of other references
+struct HTRefHasher
+{
+    size_t operator()(HTRef* ref) const;
+};
+
+// Equality functor for HTRef keys. Uses isEqual() of HTObject, identity of other references
+struct HTRefEqual
+{
+    bool operator()(HTRef* ref, HTRef* other) const;
+};
+
 NS_HT_END(Huta)
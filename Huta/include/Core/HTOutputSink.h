@@ -0,0 +1,169 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+#include <Core/HTString.h>
+#include <Core/HTStringView.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+NS_HT_BEGIN(Huta)
+
+// Destination of describeTo and of other text that is written piece by piece. Appends go
+// to a buffer that is handed to write() once full, so the output of a whole object graph
+// costs a few large writes and no allocation per piece. The sink also keeps the stack of
+// describeTo between calls, one sink reused for many dumps allocates nothing after the
+// first one.
+//
+// HTFileOutputSink sink(STDERR_FILENO);
+// state->describeTo(sink);
+class HTOutputSink: public HTNonCloneable
+{
+public:
+    static const size_t kDefaultBufferSize = 64 * 1024;
+
+    virtual ~HTOutputSink();
+
+    // Append length bytes
+    void append(const char* data, size_t length)
+    {
+        if(_buffer.size() + length <= _bufferSize)
+        {
+            _buffer.append(data, length);
+            return;
+        }
+        appendLarge(data, length);
+    }
+
+    // Append a zero terminated string
+    void append(const char* string)
+    {
+        append(string, strlen(string));
+    }
+
+    // Append the characters of a view
+    void append(const HTStringView& view)
+    {
+        append(view.data, view.length);
+    }
+
+    // Append one character
+    void appendCharacter(char character)
+    {
+        append(&character, 1);
+    }
+
+    // Append a number, a boolean or text the way HTString::format writes it
+    void appendValue(const HTFormatArgument& value);
+
+    // Hand the buffered bytes to the destination
+    virtual void flush();
+
+protected:
+    explicit HTOutputSink(size_t bufferSize);
+
+    // Write bytes to the destination
+    virtual void write(const char* data, size_t length) = 0;
+
+    std::string _buffer;
+
+private:
+    void appendLarge(const char* data, size_t length);
+
+    // One pending step of describeTo: an object to describe, written after the separator
+    // in prefix, or the closing bracket in close of a container
+    struct DescriptionStep
+    {
+        const HTRef* object;
+        uint32_t depth;
+        char prefix;
+        char close;
+    };
+
+    size_t _bufferSize;
+    std::vector<DescriptionStep> _descriptionSteps;
+    std::vector<const HTObject*> _descriptionPath;
+    std::vector<HTRef*> _descriptionElements;
+
+    friend class HTObject;
+};
+
+// Sink that collects everything in a string. Nothing is written anywhere else
+class HTStringOutputSink: public HTOutputSink
+{
+public:
+    HTStringOutputSink();
+
+    // Get the text appended so far
+    const std::string& getString() const
+    {
+        return _buffer;
+    }
+
+    // Move the text out, leaving the sink empty
+    std::string takeString();
+
+    // Remove the text but keep the memory, for reusing the sink
+    void clear()
+    {
+        _buffer.clear();
+    }
+
+    // Nothing to do, the string is the destination
+    virtual void flush();
+
+protected:
+    virtual void write(const char* data, size_t length);
+};
+
+// Sink that writes to a file descriptor, for example STDERR_FILENO or an open log file
+class HTFileOutputSink: public HTOutputSink
+{
+public:
+    // Write to descriptor in blocks of bufferSize bytes. With closeWhenDone the descriptor
+    // is closed when the sink is destroyed
+    explicit HTFileOutputSink(int descriptor, bool closeWhenDone = false, size_t bufferSize = kDefaultBufferSize);
+
+    // Flush the remaining bytes
+    ~HTFileOutputSink();
+
+    // Return true if a write failed. Output after a failure is dropped
+    bool hasFailed() const
+    {
+        return _failed;
+    }
+
+protected:
+    virtual void write(const char* data, size_t length);
+
+private:
+    int _descriptor;
+    bool _closeWhenDone;
+    bool _failed;
+};
+
+NS_HT_END(Huta)
@@ -0,0 +1,136 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+#include <Core/HTArray.h>
+#include <Core/HTDictionary.h>
+
+#include <cstdint>
+#include <functional>
+
+NS_HT_BEGIN(Huta)
+
+class HTTransientDictionary;
+struct HTHAMTNode;
+
+// Immutable dictionary stored as a hash array mapped trie. Every modification
+// returns a new version which shares all untouched nodes with the old one.
+// Lookups never modify reference counts, so a version can be read from any
+// number of threads while other versions are derived from it.
+class HTPersistentDictionary: public HTObject
+{
+public:
+    // Create an empty dictionary
+    static HTPersistentDictionary* create();
+
+    // Create a dictionary with the entries of an existing dictionary
+    static HTPersistentDictionary* createWithDictionary(HTDictionary* other);
+
+    HTPersistentDictionary();
+    ~HTPersistentDictionary();
+
+    // Initialize the dictionary. Return true if initialization is successful
+    bool init();
+
+    // Get the count of elements in dictionary
+    size_t count() const;
+
+    // Return all keys of elements
+    HTArray* allKeys() const;
+
+    // Return all values of elements
+    HTArray* allObjects() const;
+
+    // Call back for each entry, set *stop to true to end the enumeration early
+    void enumerateKeysAndObjects(const std::function<void(HTRef* key, HTRef* object, bool* stop)>& callback) const;
+
+    // Get the object according to the specified key, nullptr if there is none
+    HTRef* objectForKey(HTRef* key) const;
+
+    // Return a new version where key is matched with object
+    HTPersistentDictionary* setObject(HTRef* object, HTRef* key) const;
+
+    // Return a new version without the specified key
+    HTPersistentDictionary* removeObjectForKey(HTRef* key) const;
+
+    // Return a transient copy for batch updates. It shares nodes with this version
+    HTTransientDictionary* transient() const;
+
+    // Copy the entries into a mutable dictionary
+    HTDictionary* toDictionary() const;
+
+protected:
+    // Write the elements as a map in describeTo
+    virtual HTDescriptionKind getDescriptionKind() const;
+
+    virtual void getDescriptionElements(std::vector<HTRef*>& elements) const;
+
+private:
+    HTHAMTNode* _root;
+    size_t _count;
+
+    friend class HTTransientDictionary;
+};
+
+// Mutable builder over the same trie. Nodes created by the transient are
+// updated in place, nodes shared with persistent versions are copied first.
+// A transient must only be used from one thread at a time.
+class HTTransientDictionary: public HTObject
+{
+public:
+    // Create an empty transient dictionary
+    static HTTransientDictionary* create();
+
+    HTTransientDictionary();
+    ~HTTransientDictionary();
+
+    // Initialize the dictionary. Return true if initialization is successful
+    bool init();
+
+    // Get the count of elements in dictionary
+    size_t count() const;
+
+    // Get the object according to the specified key, nullptr if there is none
+    HTRef* objectForKey(HTRef* key) const;
+
+    // Insert an object to dictionary, and match it with the specified key
+    void setObject(HTRef* object, HTRef* key);
+
+    // Remove an object by the specified key
+    void removeObjectForKey(HTRef* key);
+
+    // Return a persistent version of current content. The transient can still
+    // be used afterwards, further updates don't affect the returned version
+    HTPersistentDictionary* persistent();
+
+private:
+    HTHAMTNode* _root;
+    size_t _count;
+    uint64_t _edit;
+
+    friend class HTPersistentDictionary;
+};
+
+NS_HT_END(Huta)
@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+
+#include <cstddef>
+#include <sys/types.h>
+
+NS_HT_BEGIN(Huta)
+
+// Location and length of a part of a string or array. location is -1 for a range
+// that was not found
+struct HTRange
+{
+    HTRange()
+    : location(-1)
+    , length(0)
+    {}
+
+    HTRange(ssize_t rangeLocation, size_t rangeLength)
+    : location(rangeLocation)
+    , length(rangeLength)
+    {}
+
+    // Return true if the range was found
+    bool isFound() const
+    {
+        return location >= 0;
+    }
+
+    // Get the position after the range
+    size_t getEnd() const
+    {
+        return static_cast<size_t>(location) + length;
+    }
+
+    bool operator==(const HTRange& other) const
+    {
+        return location == other.location && length == other.length;
+    }
+
+    bool operator!=(const HTRange& other) const
+    {
+        return !(*this == other);
+    }
+
+    ssize_t location;
+    size_t length;
+};
+
+NS_HT_END(Huta)
@@ -0,0 +1,154 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+
+#include <vector>
+#include <string>
+#include <bitset>
+#include <functional>
+
+NS_HT_BEGIN(Huta)
+
+class HTString;
+class HTArray;
+
+// Position of a capture group in the searched string, location is -1 for a group
+// that did not take part in the match
+struct HTRegexCapture
+{
+    ssize_t location;
+    size_t length;
+};
+
+// Compiled regular expression matched by a Pike VM: every input byte advances all live
+// threads of the program in lockstep, so a match costs O(pattern * input) whatever the
+// pattern and never backtracks. Syntax is the ECMAScript subset without backreferences
+// and lookaround: literals, ., classes with ranges and \d \w \s \D \W \S, ^ $ \b \B,
+// capturing and (?:) groups, |, and greedy or lazy * + ? {n} {n,} {n,m}. Matching works
+// on bytes, ^ and $ only match at the ends of the string.
+//
+// Compiled patterns are immutable and shared between threads through a process wide
+// cache of recently used patterns, so create() with a known pattern does not parse it again.
+class HTRegex: public HTObject
+{
+public:
+    enum Options
+    {
+        kNoOptions = 0,
+        kCaseInsensitive = 1 << 0
+    };
+
+    // Create a regex from the cache or by compiling pattern. Return nullptr if pattern is invalid
+    static HTRegex* create(const char* pattern);
+
+    // Create a regex with options. Return nullptr if pattern is invalid
+    static HTRegex* createWithOptions(const char* pattern, unsigned int options);
+
+    HTRegex();
+    ~HTRegex();
+
+    // Compile pattern. Return false if it is invalid
+    bool initWithPattern(const char* pattern, unsigned int options);
+
+    // Get the pattern
+    const std::string& getPattern() const
+    {
+        return _pattern;
+    }
+
+    // Get the count of capture groups, not counting the whole match
+    size_t getCaptureCount() const
+    {
+        return _captureCount;
+    }
+
+    // Return true if the whole string matches
+    bool matches(HTString* string) const;
+
+    // Return true if some part of the string matches
+    bool search(HTString* string) const;
+
+    // Find the first match starting at or after start. Captures get the whole match at index 0
+    // and one entry per group. Return false if there is no match
+    bool firstMatch(HTString* string, size_t start, std::vector<HTRegexCapture>& captures) const;
+
+    // Get the whole match and the groups of the first match as HTString, an empty string for
+    // groups that did not take part. Return nullptr if there is no match
+    HTArray* capturedStrings(HTString* string) const;
+
+    // Call callback for each non overlapping match, set *stop to true to end the enumeration early
+    void enumerateMatches(HTString* string, const std::function<void(const std::vector<HTRegexCapture>& captures, bool* stop)>& callback) const;
+
+    // Replace every match. In replacement $0 to $9 stand for the captures and $$ for a dollar sign
+    HTString* replaceAll(HTString* string, const char* replacement) const;
+
+private:
+    enum Opcode
+    {
+        kByte,
+        kAnyByte,
+        kClass,
+        kMatch,
+        kJump,
+        kSplit,
+        kSave,
+        kBegin,
+        kEnd,
+        kWordBoundary,
+        kNotWordBoundary
+    };
+
+    // Split continues at x first and at y second, Byte tests x, Class tests _classes[x],
+    // Jump goes to x and Save stores the position in capture slot x
+    struct Instruction
+    {
+        Opcode opcode;
+        int x;
+        int y;
+    };
+
+    struct Node;
+    class Parser;
+    class Matcher;
+
+    bool compile(const Node* node);
+    int emit(Opcode opcode, int x, int y);
+    void computeFirstBytes();
+    bool run(const char* text, size_t length, size_t start, bool wholeString, std::vector<size_t>& slots) const;
+
+    std::string _pattern;
+    size_t _captureCount;
+    std::vector<Instruction> _program;
+    std::vector< std::bitset<256> > _classes;
+    // Bytes a match can start with, when every match is non empty. A search skips to the
+    // next of them whenever no thread is alive
+    std::bitset<256> _firstBytes;
+    bool _hasFirstBytes;
+    // The only first byte or -1, searched with memchr
+    int _firstByte;
+};
+
+NS_HT_END(Huta)
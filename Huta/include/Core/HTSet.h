@@ -26,14 +26,55 @@
 #include <Core/HTObject.h>
 #include <Core/HTArray.h>
 
-#include <set>
+#include <vector>
+#include <iterator>
+#include <functional>
 
 
 NS_HT_BEGIN(Huta)
 
+// Unordered set of distinct objects. Objects are compared with hash() and isEqual()
+// and stored in a flat open addressing table. The set keeps the objects themselves, so an
+// object must not change in a way that changes hash() or isEqual() while it is in the set.
+// An HTString that is appended to after addObject can no longer be found.
 class HTSet: public HTObject
 {
+private:
+    struct Slot
+    {
+        size_t hash;
+        HTObject* object;
+    };
+
 public:
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef HTRef* value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef HTRef* const* pointer;
+        typedef HTRef* reference;
+
+        const_iterator(const Slot* slot, const Slot* end): _slot(slot), _end(end) { skipEmpty(); }
+
+        HTRef* operator*() const { return _slot->object; }
+
+        const_iterator& operator++() { ++_slot; skipEmpty(); return *this; }
+
+        const_iterator operator++(int) { const_iterator tmp(*this); ++(*this); return tmp; }
+
+        bool operator==(const const_iterator& other) const { return _slot == other._slot; }
+
+        bool operator!=(const const_iterator& other) const { return _slot != other._slot; }
+
+    private:
+        void skipEmpty() { while(_slot != _end && _slot->object == nullptr) ++_slot; }
+
+        const Slot* _slot;
+        const Slot* _end;
+    };
+
     HTSet();
     HTSet(const HTSet& other);
     ~HTSet();
@@ -41,12 +82,21 @@ public:
     // Create an empty set
     static HTSet* create();
 
+    // Create an empty set with room for capacity objects
+    static HTSet* createWithCapacity(size_t capacity);
+
+    // Create a set with the objects of an array
+    static HTSet* createWithArray(HTArray* array);
+
     // Return element count of the set
     size_t count() const;
 
-    // Add a certain object
+    // Add a certain object. Nothing happens if an equal object is present
     void addObject(HTObject* object);
 
+    // Add all objects of an array
+    void addObjectsFromArray(HTArray* array);
+
     // Remove a certain object
     void removeObject(HTObject* object);
 
@@ -54,12 +104,54 @@ public:
     void removeAllObjects();
 
     // Return a bool value that indicates whether object is present in set
-    bool containsObject(HTObject* object);
+    bool containsObject(HTObject* object) const;
+
+    // Return the object of set which is equal to object, nullptr if there is none
+    HTObject* member(HTObject* object) const;
+
+    // Add each object of other set which is not present in set
+    void unionSet(HTSet* other);
+
+    // Remove each object which is not present in other set
+    void intersectSet(HTSet* other);
+
+    // Remove each object which is present in other set
+    void minusSet(HTSet* other);
+
+    // Return a bool value that indicates whether every object is present in other set
+    bool isSubsetOfSet(HTSet* other) const;
+
+    // Return a bool value that indicates whether at least one object is present in other set
+    bool intersectsSet(HTSet* other) const;
 
-    // Return all objects of set
+    // Return all objects of set. Use enumerateObjects() or begin()/end() to only iterate
     HTArray* allObjects() const;
+
+    // Call back for each object, set *stop to true to end the enumeration early
+    void enumerateObjects(const std::function<void(HTRef* object, bool* stop)>& callback) const;
+
+    const_iterator begin() const { return const_iterator(_slots.data(), _slots.data() + _slots.size()); }
+
+    const_iterator end() const { return const_iterator(_slots.data() + _slots.size(), _slots.data() + _slots.size()); }
+
+protected:
+    // Write the elements as a set in describeTo
+    virtual HTDescriptionKind getDescriptionKind() const;
+
+    virtual void getDescriptionElements(std::vector<HTRef*>& elements) const;
+
 private:
-    std::set<HTRef*> _set;
+    size_t homeOf(size_t hash) const;
+    ssize_t findSlot(size_t hash, const HTObject* object) const;
+    bool insertSlot(const Slot& slot);
+    void eraseSlot(size_t index);
+    void rehash(size_t capacity);
+    void reserve(size_t count);
+    void filterWithSet(HTSet* other, bool keepMembers);
+
+    std::vector<Slot> _slots;
+    size_t _count;
+    unsigned int _shift;
 };
 
-NS_HT_END(Huta)
\ No newline at end of file
+NS_HT_END(Huta)
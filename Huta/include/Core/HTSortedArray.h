@@ -0,0 +1,144 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+
+#include <vector>
+#include <functional>
+
+NS_HT_BEGIN(Huta)
+
+class HTArray;
+
+// Array kept in ascending order under a comparator, for lookup tables that are read
+// much more often than written. Lookups run a branchless binary search whose loop count
+// only depends on the size. For large arrays an Eytzinger copy of the order can be kept,
+// it stores the search tree breadth first so the next probes of a lookup sit together
+// in memory and can be prefetched.
+class HTSortedArray: public HTObject
+{
+public:
+    // Return true if a is ordered before b
+    typedef std::function<bool(HTRef* a, HTRef* b)> Comparator;
+
+    typedef std::vector<HTRefPtr<HTRef>>::const_iterator const_iterator;
+
+    // Create an empty array ordered by comparator
+    static HTSortedArray* createWithComparator(const Comparator& comparator);
+
+    // Create an array with the elements of an array in any order
+    static HTSortedArray* createWithArray(HTArray* array, const Comparator& comparator);
+
+    HTSortedArray();
+    ~HTSortedArray();
+
+    // Initialize an empty array
+    bool initWithComparator(const Comparator& comparator);
+
+    // Initialize an array with the elements of an array in any order
+    bool initWithArray(HTArray* array, const Comparator& comparator);
+
+    // Return element count of the array
+    size_t count() const
+    {
+        return _data.size();
+    }
+
+    // Return an element with a certain index
+    HTRef* getObjectAtIndex(size_t index) const;
+
+    // Return the index of the first element not ordered before object
+    size_t lowerBound(HTRef* object) const;
+
+    // Return the index of the first element ordered after object
+    size_t upperBound(HTRef* object) const;
+
+    // Return the index of an element equivalent to object, -1 if there is none
+    ssize_t indexOfObject(HTRef* object) const;
+
+    // Return the index of an element equivalent to each object, -1 for the missing ones.
+    // The queries are searched in sorted order, each search starts at the previous result
+    std::vector<ssize_t> indexesOfObjects(HTArray* objects) const;
+
+    // Return a bool value that indicates whether an equivalent element is present
+    bool containsObject(HTRef* object) const;
+
+    // Insert an object after its equivalent elements and return its index
+    size_t addObject(HTRef* object);
+
+    // Merge the elements of an array that is already sorted by the comparator
+    void addObjectsFromSortedArray(HTArray* sorted);
+
+    // Sort the elements of an array and merge them
+    void addObjectsFromArray(HTArray* array);
+
+    // Remove one element equivalent to object. Return true if there was one
+    bool removeObject(HTRef* object);
+
+    // Remove object at a certain index
+    void removeObjectAtIndex(size_t index);
+
+    // Remove all objects
+    void removeAllObjects();
+
+    // Keep an Eytzinger copy of the order for lookups, it costs one pointer and one index
+    // per element and is only used above a few hundred elements
+    void setUsesEytzingerLayout(bool usesEytzingerLayout);
+
+    // Get whether lookups may use the Eytzinger copy
+    bool getUsesEytzingerLayout() const
+    {
+        return _usesEytzingerLayout;
+    }
+
+    // Get all objects in order
+    HTArray* allObjects() const;
+
+    const_iterator begin() const { return _data.begin(); }
+
+    const_iterator end() const { return _data.end(); }
+
+protected:
+    // Write the elements as a list in describeTo
+    virtual HTDescriptionKind getDescriptionKind() const;
+
+    virtual void getDescriptionElements(std::vector<HTRef*>& elements) const;
+
+private:
+    size_t searchSorted(HTRef* object, size_t first, size_t length, bool upper) const;
+    size_t searchEytzinger(HTRef* object) const;
+    void mergeSorted(std::vector<HTRefPtr<HTRef>>& sorted);
+    void rebuildEytzinger();
+    void placeEytzinger(size_t& next, size_t node);
+
+    Comparator _comparator;
+    std::vector<HTRefPtr<HTRef>> _data;
+    bool _usesEytzingerLayout;
+    // Search tree in breadth first order from slot 1, with the sorted index of each slot
+    std::vector<HTRef*> _eytzinger;
+    std::vector<size_t> _eytzingerIndex;
+};
+
+NS_HT_END(Huta)
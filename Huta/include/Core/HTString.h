@@ -24,9 +24,108 @@
 
 #include <Core/HTObject.h>
 #include <Core/HTArray.h>
+#include <Core/HTStringView.h>
+#include <Core/HTStringSplitter.h>
+#include <Core/HTNumberParser.h>
+#include <Core/HTRange.h>
+
+#include <string>
+#include <cstdint>
+#include <type_traits>
 
 NS_HT_BEGIN(Huta)
 
+// Returned by HTFormatPlaceholderCount for a brace that is neither {} nor {{ or }}
+static const size_t kHTFormatMalformed = static_cast<size_t>(-1);
+
+// Count the {} placeholders of a format string, usable in constant expressions
+constexpr size_t HTFormatPlaceholderCount(const char* format, size_t count = 0)
+{
+    return format[0] == '\0' ? count
+        : (format[0] == '{' && format[1] == '{') ? HTFormatPlaceholderCount(format + 2, count)
+        : (format[0] == '}' && format[1] == '}') ? HTFormatPlaceholderCount(format + 2, count)
+        : (format[0] == '{' && format[1] == '}') ? HTFormatPlaceholderCount(format + 2, count + 1)
+        : (format[0] == '{' || format[0] == '}') ? kHTFormatMalformed
+        : HTFormatPlaceholderCount(format + 1, count);
+}
+
+// Returned by HTFormatLiteralPlaceholderCount for a literal that is not counted
+static const size_t kHTFormatUnchecked = static_cast<size_t>(-2);
+
+// Longest literal HTFormatLiteralPlaceholderCount counts. The count recurses once per
+// character, so a longer literal would exceed the constexpr depth limit of compilers
+static const size_t kHTFormatMaximumCheckedLength = 256;
+
+// Count the {} placeholders of a string literal, kHTFormatUnchecked if it is too long to
+// count at compile time. format() still checks such a literal when it runs
+template <size_t length>
+constexpr size_t HTFormatLiteralPlaceholderCount(const char (&format)[length])
+{
+    return length > kHTFormatMaximumCheckedLength ? kHTFormatUnchecked : HTFormatPlaceholderCount(format);
+}
+
+class HTStringSlice;
+
+// One argument of HTString::format, converted from the supported types
+class HTFormatArgument
+{
+public:
+    enum Type
+    {
+        kNone,
+        kSigned,
+        kUnsigned,
+        kDouble,
+        kBool,
+        kCharacter,
+        kCharacters,
+        kObject
+    };
+
+    HTFormatArgument(): _type(kNone) { _signed = 0; }
+    HTFormatArgument(int value): _type(kSigned) { _signed = value; }
+    HTFormatArgument(long value): _type(kSigned) { _signed = value; }
+    HTFormatArgument(long long value): _type(kSigned) { _signed = value; }
+    HTFormatArgument(unsigned int value): _type(kUnsigned) { _unsigned = value; }
+    HTFormatArgument(unsigned long value): _type(kUnsigned) { _unsigned = value; }
+    HTFormatArgument(unsigned long long value): _type(kUnsigned) { _unsigned = value; }
+    HTFormatArgument(double value): _type(kDouble) { _double = value; }
+    HTFormatArgument(bool value): _type(kBool) { _signed = value ? 1 : 0; }
+    HTFormatArgument(char value): _type(kCharacter) { _signed = value; }
+    HTFormatArgument(const char* value): _type(kCharacters) { _view = value ? HTStringView(value) : HTStringView("(null)"); }
+    HTFormatArgument(const std::string& value): _type(kCharacters) { _view = HTStringView(value); }
+    HTFormatArgument(const HTStringView& value): _type(kCharacters) { _view = value; }
+    HTFormatArgument(const HTRef* value): _type(kObject) { _object = value; }
+    HTFormatArgument(std::nullptr_t): _type(kCharacters) { _view = HTStringView("(null)"); }
+
+    template<typename T>
+    HTFormatArgument(const HTRefPtr<T>& value): _type(kObject) { _object = value.get(); }
+
+    // Any other pointer would silently convert to bool, so it does not compile
+    template<typename T, typename = typename std::enable_if<!std::is_base_of<HTRef, T>::value>::type>
+    HTFormatArgument(const T* value) = delete;
+
+    // Get the type of the value
+    Type getType() const
+    {
+        return _type;
+    }
+
+    // Append the text of the argument
+    void appendTo(std::string& string) const;
+
+private:
+    Type _type;
+    union
+    {
+        int64_t _signed;
+        uint64_t _unsigned;
+        double _double;
+        const HTRef* _object;
+    };
+    HTStringView _view;
+};
+
 class HTString: public HTObject, public HTClonable
 {
 public:
@@ -36,6 +135,9 @@ public:
 
     HTString(const std::string& str);
 
+    // Take the characters of str without copying them
+    HTString(std::string&& str);
+
     HTString(const HTString& str);
 
     virtual ~HTString();
@@ -44,23 +146,33 @@ public:
     HTString& operator=(const HTString& other);
 
     // Init a string with format
-    bool initWithFormat(const char* format, ...);
+    bool initWithFormat(const char* format, ...) HT_FORMAT_PRINTF(2, 3);
 
-    // Convert to int value
+    // Convert to int value. Leading white space is skipped and trailing characters are
+    // ignored like std::stoi does, std::invalid_argument or std::out_of_range is thrown
     int intValue() const;
 
-    // Convert to unsigned int value
+    // Convert to unsigned int value, a negative numeral is invalid
     unsigned int uintValue() const;
 
-    // Convert to float value
+    // Convert to float value like std::stof, except that hexadecimal numerals are not
+    // accepted: "0x10" is 0
     float floatValue() const;
 
-    // Convert to double value
+    // Convert to double value like std::stod, with the same exception for hexadecimal
     double doubleValue() const;
 
     // Convert to bool value
     bool boolValue() const;
 
+    // Parse the whole string as a numeral of type T, without exceptions or locale, see
+    // HTNumberParser. value is only written on kHTParseSuccess
+    template<typename T>
+    HTParseStatus parseValue(T& value) const
+    {
+        return HTNumberParser::parseAll(HTStringView(_string), value);
+    }
+
     // Get the C string
     const char* getCString() const;
 
@@ -70,31 +182,178 @@ public:
     // Compare to a c string
     int compare(const char*) const;
 
+    // Compare with ASCII letters folded to lower case
+    int compareIgnoringCase(const char* string) const;
+
+    // Find the first occurrence of string at or after start. Return a range with location -1
+    // if there is none
+    HTRange rangeOfString(const char* string, size_t start = 0) const;
+
+    // Return true if string occurs in this string
+    bool containsString(const char* string) const;
+
+    // Return true if this string starts with prefix
+    bool hasPrefix(const char* prefix) const;
+
+    // Return true if this string ends with suffix
+    bool hasSuffix(const char* suffix) const;
+
+    // Count the occurrences of string that do not overlap
+    size_t occurrencesOfString(const char* string) const;
+
+    // Return true if the string is valid UTF-8. The answer is kept until the string changes
+    bool isValidUTF8() const;
+
+    // Return true if every character is ASCII. The answer is kept until the string changes
+    bool isASCII() const;
+
+    // Count the code points, length() counts bytes. The count is kept until the string changes
+    size_t codePointCount() const;
+
+    // Convert to UTF-16. Return false if the string is not valid UTF-8
+    bool getUTF16String(std::u16string& result) const;
+
+    // Convert to UTF-32. Return false if the string is not valid UTF-8
+    bool getUTF32String(std::u32string& result) const;
+
     // Append additional characters at the end 
     void append(const std::string& str);
 
     // Append format additional character at the end 
-    void appendFormat(const char* format, ...);
+    void appendFormat(const char* format, ...) HT_FORMAT_PRINTF(2, 3);
 
     virtual bool isEqual(const HTObject* other);
 
-    // Split a string
+    virtual size_t hash() const;
+
+    // Split a string. The delimiter is a regular expression, one without special characters
+    // is searched as plain text without building a std::regex
     HTArray* componentsSeparatedByString(const char* delimiter);
 
+    // Get a splitter over the components around a literal delimiter, see HTStringSplitter.
+    // The delimiter and this string must outlive the splitter
+    HTStringSplitter splitterWithDelimiter(const char* delimiter) const;
+
+    // Create a slice of length characters at offset that shares the characters of this
+    // string. Throw an exception if the range is out of bounds
+    HTStringSlice* sliceWithRange(size_t offset, size_t length);
+
+    // Split around a literal delimiter into HTStringSlice components that share the
+    // characters of this string. The components are the ones of splitterWithDelimiter
+    HTArray* slicesSeparatedByString(const char* delimiter);
+
     // Create a string with std string
     static HTString* create(const std::string& str);
 
-    // Create a string with binary data
-    static HTString* createWithData(const unsigned char* data, size_t len);
+    // Create a string that takes the characters of str without copying them
+    static HTString* create(std::string&& str);
+
+    // Create a string from UTF-16. Return nullptr if data has an unpaired surrogate
+    static HTString* createWithUTF16(const char16_t* data, size_t length);
+
+    // Create a string from UTF-32. Return nullptr if data is not valid UTF-32
+    static HTString* createWithUTF32(const char32_t* data, size_t length);
+
+    // Create a string with binary data. With validateUTF8 return nullptr if data is not
+    // valid UTF-8, the result is then known to be valid without checking it again
+    static HTString* createWithData(const unsigned char* data, size_t len, bool validateUTF8 = false);
 
     // Create a string with format
-    static HTString* createWithFormat(const char* format, ...);
+    static HTString* createWithFormat(const char* format, ...) HT_FORMAT_PRINTF(1, 2);
+
+    // Create a string by replacing each {} of format with the next argument, {{ and }} stand
+    // for braces. Integers, floating point numbers, bool, characters, C and std strings,
+    // HTStringView and HTObject pointers are accepted, objects are written through toString().
+    // Throw HTException if the placeholders do not match the arguments, use HT_FORMAT to
+    // check a literal format at compile time instead
+    template <typename... Args>
+    static HTString* format(const char* formatString, const Args&... args)
+    {
+        // The extra element keeps the array non empty when there are no arguments
+        const HTFormatArgument arguments[] = { HTFormatArgument(args)..., HTFormatArgument() };
+        return createWithArguments(formatString, arguments, sizeof...(Args));
+    }
+
+    // format() for a format whose placeholders were counted at compile time, see HT_FORMAT
+    template <size_t placeholderCount, typename... Args>
+    static HTString* formatChecked(const char* formatString, const Args&... args)
+    {
+        static_assert(placeholderCount != kHTFormatMalformed, "Malformed format string, write {{ and }} for braces");
+        static_assert(placeholderCount == kHTFormatUnchecked || placeholderCount == sizeof...(Args), "Format placeholder count does not match the argument count");
+        return format(formatString, args...);
+    }
+
+    // Append the formatted arguments at the end, like format()
+    template <typename... Args>
+    void appendFormatted(const char* formatString, const Args&... args)
+    {
+        const HTFormatArgument arguments[] = { HTFormatArgument(args)..., HTFormatArgument() };
+        appendArguments(formatString, arguments, sizeof...(Args));
+    }
+
+    // Get the interned string with the same characters. Interned strings are immortal and
+    // immutable, there is one per content, so equal interned strings are the same pointer
+    // and their hash is computed once. Changing one throws an exception
+    HTString* intern() const;
+
+    // Get the interned string with characters
+    static HTString* createInterned(const HTStringView& characters);
+
+    // Return true if this is an interned string
+    bool isInterned() const
+    {
+        return _interned;
+    }
 
     // Clonable
     virtual HTString* clone() const;
 
+protected:
+    // Write the characters
+    virtual void describeSelfTo(HTOutputSink& sink) const;
+
 private:
+    static HTString* createWithArguments(const char* format, const HTFormatArgument* arguments, size_t count);
+    void appendArguments(const char* format, const HTFormatArgument* arguments, size_t count);
+
+    // Forget what was computed from the characters, called whenever they change
+    void resetCachedState();
+
+    // Throw an exception if the string is interned
+    void checkMutable() const;
+
+    // Create the one interned instance of characters, for the intern table
+    static HTString* createInternedInstance(const HTStringView& characters, size_t hash);
+
+    // Check the encoding once and return the kEncoding bits
+    unsigned int getEncodingState() const;
+
+    enum
+    {
+        kEncodingChecked = 1 << 0,
+        kEncodingValidUTF8 = 1 << 1,
+        kEncodingASCII = 1 << 2
+    };
+
     std::string _string;
+
+    // Facts about the characters, computed on first use. Atomic because strings are shared
+    // read only between threads, a race only computes the same value twice
+    mutable std::atomic<unsigned int> _encodingState;
+    mutable std::atomic<size_t> _codePointCount;
+    mutable std::atomic<size_t> _hash;
+    mutable std::atomic<bool> _hasHash;
+    bool _interned;
+
+    friend class HTStringInternTable;
 };
 
-NS_HT_END(Huta)
\ No newline at end of file
+NS_HT_END(Huta)
+
+#define HT_FORMAT_FIRST_ARGUMENT(first, ...) first
+
+// Format a string literal whose placeholder count is checked against the arguments at compile time:
+// HTString* key = HT_FORMAT("{}:{}", user, session);
+// Literals longer than kHTFormatMaximumCheckedLength are only checked at run time
+#define HT_FORMAT(...) ::Huta::HTString::formatChecked< \
+    ::Huta::HTFormatLiteralPlaceholderCount(HT_FORMAT_FIRST_ARGUMENT(__VA_ARGS__, 0))>(__VA_ARGS__)
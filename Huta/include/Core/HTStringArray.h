@@ -0,0 +1,135 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+#include <Core/HTStringView.h>
+
+#include <vector>
+#include <string>
+#include <functional>
+
+NS_HT_BEGIN(Huta)
+
+class HTArray;
+class HTString;
+
+// Array of strings packed into one character buffer, each string followed by a zero
+// byte, plus one offset per string. A million short strings cost two allocations instead
+// of a million objects. Elements are read as views into the buffer, HTString objects are
+// only created when asked for. Adding strings may move the buffer, which invalidates the
+// views handed out before.
+class HTStringArray: public HTObject
+{
+public:
+    // Create an empty array
+    static HTStringArray* create();
+
+    // Create an empty array with room for count strings of byteCount characters in total
+    static HTStringArray* createWithCapacity(size_t count, size_t byteCount);
+
+    // Create an array from an array of HTString and HTStringSlice. Throw an exception for
+    // other elements
+    static HTStringArray* createWithArray(HTArray* array);
+
+    HTStringArray();
+    ~HTStringArray();
+
+    // Initialize an empty array with capacity
+    bool initWithCapacity(size_t count, size_t byteCount);
+
+    // Return string count of the array
+    size_t count() const
+    {
+        return _offsets.size() - 1;
+    }
+
+    // Get the count of characters of all strings, without the zero bytes
+    size_t characterCount() const
+    {
+        return _characters.size() - count();
+    }
+
+    // Get the view of the string at index. The characters are followed by a zero byte
+    HTStringView viewAtIndex(size_t index) const
+    {
+        return HTStringView(&_characters[_offsets[index]], _offsets[index + 1] - _offsets[index] - 1);
+    }
+
+    // Get a zero terminated pointer to the string at index
+    const char* getCStringAtIndex(size_t index) const
+    {
+        return &_characters[_offsets[index]];
+    }
+
+    // Create an HTString with a copy of the string at index
+    HTString* stringAtIndex(size_t index) const;
+
+    // Add characters as a new string
+    void addString(const char* characters, size_t length);
+
+    // Add a string
+    void addString(const std::string& string);
+
+    // Add the characters of an HTString
+    void addString(HTString* string);
+
+    // Add all strings of another array
+    void addStringsFromArray(HTStringArray* other);
+
+    // Return the index of the first string equal to view, -1 if there is none
+    ssize_t indexOfString(const HTStringView& view) const;
+
+    // Sort the strings bytewise ascending
+    void sort();
+
+    // Remove repeated strings, keeping the first occurrence of each
+    void removeDuplicates();
+
+    // Remove all strings
+    void removeAllStrings();
+
+    // Call callback for each string in order, set *stop to true to end the enumeration early
+    void enumerateStrings(const std::function<void(const HTStringView& view, size_t index, bool* stop)>& callback) const;
+
+    // Get the strings as an array of HTString
+    HTArray* toArray() const;
+
+    // Get the memory used by the buffer and the offsets
+    size_t getByteSize() const;
+
+protected:
+    // Write the strings as a list. They are values rather than objects, so the array is a leaf
+    virtual void describeSelfTo(HTOutputSink& sink) const;
+
+private:
+    // Rebuild the buffer with the strings at indexes, in that order
+    void keepIndexes(const std::vector<size_t>& indexes);
+
+    std::vector<char> _characters;
+    // Start of every string in _characters, followed by the end of the buffer
+    std::vector<size_t> _offsets;
+};
+
+NS_HT_END(Huta)
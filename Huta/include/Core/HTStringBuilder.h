@@ -0,0 +1,123 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+#include <Core/HTStringView.h>
+#include <Core/HTString.h>
+
+#include <string>
+#include <vector>
+#include <functional>
+
+NS_HT_BEGIN(Huta)
+
+// Builds a long string out of many appends. The characters are kept in a list of chunks
+// that grow geometrically up to a limit, so an append copies its characters once and never
+// moves the characters appended before it. The chunks can be written out one by one, for
+// example with writev, or joined into an HTString with a single copy.
+//
+// HTStringBuilder* builder = HTStringBuilder::create();
+// builder->append("id=");
+// builder->appendValue(identifier);
+// HTString* string = builder->takeString();
+class HTStringBuilder: public HTObject
+{
+public:
+    static HTStringBuilder* create();
+
+    // Create a builder whose first chunk holds byteCount characters
+    static HTStringBuilder* createWithCapacity(size_t byteCount);
+
+    HTStringBuilder();
+    ~HTStringBuilder();
+
+    bool initWithCapacity(size_t byteCount);
+
+    // Get the count of characters
+    size_t length() const
+    {
+        return _length;
+    }
+
+    // Get the count of chunks
+    size_t getChunkCount() const
+    {
+        return _chunks.size();
+    }
+
+    // Get the characters of a chunk. Appending may change the last chunk
+    HTStringView getChunkAtIndex(size_t index) const;
+
+    // Call callback with the characters of each chunk in order, set *stop to true to end early
+    void enumerateChunks(const std::function<void(const HTStringView& chunk, bool* stop)>& callback) const;
+
+    // Make room for byteCount more characters, so they are appended without allocating
+    void reserve(size_t byteCount);
+
+    // Append length characters
+    void append(const char* characters, size_t length);
+
+    // Append a zero terminated string
+    void append(const char* string);
+
+    // Append the characters of a view
+    void append(const HTStringView& view);
+
+    // Append the characters of a string
+    void append(HTString* string);
+
+    // Append a character
+    void appendCharacter(char character);
+
+    // Append a number, string or object the way HTString::format writes it
+    void appendValue(const HTFormatArgument& value);
+
+    // Append printf style formatted characters
+    void appendFormat(const char* format, ...) HT_FORMAT_PRINTF(2, 3);
+
+    // Remove all characters, the first chunk is kept for reuse
+    void removeAllCharacters();
+
+    // Copy the characters into a new HTString
+    virtual HTString* toString() const;
+
+    // Move the characters into a new HTString and empty the builder. A single chunk becomes
+    // the string without a copy, several chunks are copied once
+    HTString* takeString();
+
+protected:
+    // Write the characters chunk by chunk
+    virtual void describeSelfTo(HTOutputSink& sink) const;
+
+private:
+    // Append a chunk for at least byteCount characters
+    void addChunk(size_t byteCount);
+
+    // Each chunk is filled up to its capacity before the next one is added
+    std::vector<std::string> _chunks;
+    size_t _length;
+};
+
+NS_HT_END(Huta)
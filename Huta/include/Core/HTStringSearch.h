@@ -0,0 +1,60 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTStringView.h>
+
+#include <sys/types.h>
+
+NS_HT_BEGIN(Huta)
+
+// Byte string search. On x86 the first and last byte of the needle are compared against
+// 32 (AVX2) or 16 (SSE2) positions of the haystack at once and only positions where both
+// match are checked with memcmp. The instruction set is picked at run time from the CPU,
+// so the library does not have to be built for AVX2. Other targets use memchr and memcmp.
+class HTStringSearch
+{
+public:
+    // Get the position of the first occurrence of needle at or after start, -1 if there is
+    // none. An empty needle is found at start
+    static ssize_t find(const HTStringView& haystack, const HTStringView& needle, size_t start = 0);
+
+    // Count the occurrences of needle that do not overlap. An empty needle occurs 0 times
+    static size_t count(const HTStringView& haystack, const HTStringView& needle);
+
+    // Return true if string starts with prefix
+    static bool hasPrefix(const HTStringView& string, const HTStringView& prefix);
+
+    // Return true if string ends with suffix
+    static bool hasSuffix(const HTStringView& string, const HTStringView& suffix);
+
+    // Compare bytewise with ASCII letters folded to lower case. Return a negative value,
+    // 0 or a positive value
+    static int compareIgnoringCase(const HTStringView& string, const HTStringView& other);
+
+private:
+    HTStringSearch() = delete;
+};
+
+NS_HT_END(Huta)
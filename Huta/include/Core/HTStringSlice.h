@@ -0,0 +1,153 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTObject.h>
+#include <Core/HTStringView.h>
+#include <Core/HTNumberParser.h>
+#include <Core/HTRange.h>
+
+#include <string>
+
+NS_HT_BEGIN(Huta)
+
+class HTString;
+
+// Substring of an HTString that shares the characters of its parent instead of copying
+// them. The slice retains the parent and reads the range through it, so appending to the
+// parent keeps the slice valid, shortening the parent below the end of the slice does not.
+// Characters are not zero terminated, toString() makes an HTString copy when one is needed.
+class HTStringSlice: public HTObject
+{
+public:
+    // Create a slice of the whole string
+    static HTStringSlice* create(HTString* string);
+
+    // Create a slice of length characters at offset. Throw an exception if the range is out of bounds
+    static HTStringSlice* createWithRange(HTString* string, size_t offset, size_t length);
+
+    HTStringSlice();
+    ~HTStringSlice();
+
+    bool initWithRange(HTString* string, size_t offset, size_t length);
+
+    // Get the parent string
+    HTString* getString() const
+    {
+        return _string;
+    }
+
+    // Get the offset of the slice in the parent string
+    size_t getOffset() const
+    {
+        return _offset;
+    }
+
+    // Get the count of characters
+    size_t length() const
+    {
+        return _length;
+    }
+
+    // Return true if the slice has no characters
+    bool isEmpty() const
+    {
+        return _length == 0;
+    }
+
+    // Get the first character. The characters are not zero terminated
+    const char* getCharacters() const;
+
+    // Get a view of the characters
+    HTStringView getView() const;
+
+    // Get the character at index. Throw an exception if index is out of range
+    char characterAtIndex(size_t index) const;
+
+    // Create a slice of this slice, sharing the same parent. Throw an exception if the
+    // range is out of bounds
+    HTStringSlice* sliceWithRange(size_t offset, size_t length) const;
+
+    // Create a slice without the leading and trailing white space
+    HTStringSlice* trimmedSlice() const;
+
+    // Compare bytewise with a zero terminated string. Return a negative value, 0 or a positive value
+    int compare(const char* string) const;
+
+    // Compare bytewise with a view
+    int compare(const HTStringView& view) const;
+
+    // Return true if the slice starts with prefix
+    bool hasPrefix(const char* prefix) const;
+
+    // Return true if the slice ends with suffix
+    bool hasSuffix(const char* suffix) const;
+
+    // Find the first occurrence of string at or after start, relative to the slice. Return
+    // a range with location -1 if there is none
+    HTRange rangeOfString(const char* string, size_t start = 0) const;
+
+    // Numeric values, parsed in place like the HTString ones. Throw std::invalid_argument
+    // or std::out_of_range
+    int intValue() const;
+
+    unsigned int uintValue() const;
+
+    float floatValue() const;
+
+    double doubleValue() const;
+
+    // Return false for an empty slice, "0" and "false", true otherwise
+    bool boolValue() const;
+
+    // Parse the whole slice as a numeral of type T without exceptions, see HTNumberParser
+    template<typename T>
+    HTParseStatus parseValue(T& value) const
+    {
+        return HTNumberParser::parseAll(getView(), value);
+    }
+
+    // Copy the characters into a std string
+    std::string toStdString() const;
+
+    // Equal to slices and HTString with the same characters
+    virtual bool isEqual(const HTObject* object);
+
+    // Same hash as an HTString with the same characters
+    virtual size_t hash() const;
+
+    // Copy the characters into a new HTString
+    virtual HTString* toString() const;
+
+protected:
+    // Write the characters
+    virtual void describeSelfTo(HTOutputSink& sink) const;
+
+private:
+    HTString* _string;
+    size_t _offset;
+    size_t _length;
+};
+
+NS_HT_END(Huta)
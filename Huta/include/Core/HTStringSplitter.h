@@ -0,0 +1,58 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTStringView.h>
+
+NS_HT_BEGIN(Huta)
+
+// Splits a string around a literal delimiter one component at a time. Components are
+// views into the split string, nothing is allocated, so the string must stay unchanged
+// while the splitter is used. The components are the same as the ones returned by
+// HTString::componentsSeparatedByString: the text before every delimiter, then the text
+// after the last delimiter if it is not empty.
+//
+// HTStringSplitter splitter = line->splitterWithDelimiter(",");
+// HTStringView field;
+// while(splitter.next(field)) { ... }
+class HTStringSplitter
+{
+public:
+    HTStringSplitter(const HTStringView& string, const HTStringView& delimiter);
+
+    // Get the next component. Return false when there are no more components
+    bool next(HTStringView& component);
+
+private:
+    // Return the start of the next delimiter at or after _position, nullptr if there is none
+    const char* findDelimiter() const;
+
+    const char* _position;
+    const char* _end;
+    HTStringView _delimiter;
+    bool _matched;
+    bool _done;
+};
+
+NS_HT_END(Huta)
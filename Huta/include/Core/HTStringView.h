@@ -0,0 +1,110 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+#include <Core/HTHash.h>
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+NS_HT_BEGIN(Huta)
+
+// Non owning view of characters that live in some other storage. A view is only valid
+// while that storage is neither changed nor freed
+struct HTStringView
+{
+    HTStringView()
+    : data("")
+    , length(0)
+    {}
+
+    HTStringView(const char* characters, size_t count)
+    : data(characters)
+    , length(count)
+    {}
+
+    explicit HTStringView(const char* string)
+    : data(string)
+    , length(strlen(string))
+    {}
+
+    explicit HTStringView(const std::string& string)
+    : data(string.data())
+    , length(string.size())
+    {}
+
+    // Copy the characters into a std string
+    std::string toStdString() const
+    {
+        return std::string(data, length);
+    }
+
+    // Compare bytewise. Return a negative value, 0 or a positive value
+    int compare(const HTStringView& other) const
+    {
+        size_t common = length < other.length ? length : other.length;
+        int result = common > 0 ? memcmp(data, other.data, common) : 0;
+        if(result != 0)
+        {
+            return result;
+        }
+        return length < other.length ? -1 : (length > other.length ? 1 : 0);
+    }
+
+    // Hash of the bytes with the process seed, strings often come from outside
+    size_t hash() const
+    {
+        return static_cast<size_t>(HTHash::hashBytesSeeded(data, length));
+    }
+
+    bool operator==(const HTStringView& other) const
+    {
+        return length == other.length && (length == 0 || memcmp(data, other.data, length) == 0);
+    }
+
+    bool operator!=(const HTStringView& other) const
+    {
+        return !(*this == other);
+    }
+
+    bool operator<(const HTStringView& other) const
+    {
+        return compare(other) < 0;
+    }
+
+    const char* data;
+    size_t length;
+};
+
+// Hash functor for HTStringView keys
+struct HTStringViewHasher
+{
+    size_t operator()(const HTStringView& view) const
+    {
+        return view.hash();
+    }
+};
+
+NS_HT_END(Huta)
@@ -0,0 +1,66 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <Core/HTMacros.h>
+
+#include <string>
+#include <cstddef>
+
+NS_HT_BEGIN(Huta)
+
+// UTF-8 checks and conversions on byte buffers. Runs of ASCII are handled 16 bytes at a
+// time with SSE2 on x86 and 8 bytes at a time elsewhere, so mostly ASCII text is checked
+// at memory speed and only the other characters are decoded one by one. Valid UTF-8 is
+// the one of RFC 3629: shortest forms only, no surrogates, nothing above U+10FFFF.
+class HTUTF8
+{
+public:
+    // Return true if every byte is below 0x80
+    static bool isASCII(const char* data, size_t length);
+
+    // Return true if data is valid UTF-8. If it is not and errorOffset is not nullptr, set it
+    // to the offset of the first invalid sequence
+    static bool validate(const char* data, size_t length, size_t* errorOffset = nullptr);
+
+    // Count the code points of valid UTF-8. For invalid data this counts the bytes that are
+    // not continuation bytes
+    static size_t countCodePoints(const char* data, size_t length);
+
+    // Convert UTF-8 to UTF-16. Return false if data is not valid UTF-8
+    static bool toUTF16(const char* data, size_t length, std::u16string& result);
+
+    // Convert UTF-8 to UTF-32. Return false if data is not valid UTF-8
+    static bool toUTF32(const char* data, size_t length, std::u32string& result);
+
+    // Convert UTF-16 to UTF-8. Return false if data has an unpaired surrogate
+    static bool fromUTF16(const char16_t* data, size_t length, std::string& result);
+
+    // Convert UTF-32 to UTF-8. Return false if data has a surrogate or a value above U+10FFFF
+    static bool fromUTF32(const char32_t* data, size_t length, std::string& result);
+
+private:
+    HTUTF8() = delete;
+};
+
+NS_HT_END(Huta)
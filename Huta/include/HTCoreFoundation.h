@@ -23,11 +23,33 @@
 #pragma once
 
 #include <Core/HTMacros.h>
+#include <Core/HTHash.h>
 #include <Core/HTRef.h>
 #include <Core/HTObject.h>
+#include <Core/HTOutputSink.h>
 #include <Core/HTArray.h>
+#include <Core/HTData.h>
+#include <Core/HTIndexSet.h>
+#include <Core/HTStringView.h>
+#include <Core/HTRange.h>
 #include <Core/HTString.h>
+#include <Core/HTStringArray.h>
+#include <Core/HTStringBuilder.h>
+#include <Core/HTStringSearch.h>
+#include <Core/HTStringSlice.h>
+#include <Core/HTStringSplitter.h>
+#include <Core/HTUTF8.h>
+#include <Core/HTRegex.h>
+#include <Core/HTNumber.h>
+#include <Core/HTNumberArray.h>
+#include <Core/HTNumberParser.h>
 #include <Core/HTDictionary.h>
+#include <Core/HTPersistentDictionary.h>
 #include <Core/HTSet.h>
+#include <Core/HTCountedSet.h>
+#include <Core/HTBloomFilter.h>
+#include <Core/HTHeap.h>
+#include <Core/HTSortedArray.h>
 #include <Core/HTAutoreleasePool.h>
+#include <Core/HTCache.h>
 #include <Core/HTException.h>
\ No newline at end of file
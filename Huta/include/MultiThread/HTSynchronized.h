@@ -25,6 +25,7 @@
 #include <Core/HTMacros.h>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
 
 NS_HT_BEGIN(Huta)
 
@@ -49,7 +50,7 @@ private:
 class HTLock
 {
 public:
-    HTLock(HTMutex &mutex):_mutex(mutex), _locked(false) 
+    HTLock(HTMutex &mutex):_mutex(mutex), _locked(true) 
     {
         _mutex.lock();
     }
@@ -24,6 +24,9 @@
 
 #include <Core/HTObject.h>
 
+#include <memory>
+#include <functional>
+
 NS_HT_BEGIN(Huta)
 
 class HTRunnable
@@ -39,12 +39,22 @@ public:
     GUID &operator=(const GUID &other);
     bool operator==(const GUID &other) const;
     bool operator!=(const GUID &other) const;
+
+    // Hash of the bytes with the process seed
+    size_t hash() const;
 private:
     std::vector<unsigned char> _bytes;
 
     friend std::ostream &operator <<(std::ostream &stream, const GUID& guid);
 };
 
+// Hash functor for GUID keys
+struct GUIDHasher {
+    size_t operator()(const GUID &guid) const {
+        return guid.hash();
+    }
+};
+
 class GUIDGenerator {
 public:
     GUIDGenerator();
@@ -21,6 +21,8 @@
 // THE SOFTWARE.
 
 #include <Core/HTArray.h>
+#include <Core/HTIndexSet.h>
+#include <Core/HTException.h>
 
 NS_HT_BEGIN(Huta)
 HTArray::HTArray()
@@ -181,6 +183,34 @@ HTRef* HTArray::getLastObject()
     return _data.back().get();
 }
 
+HTArray* HTArray::objectsAtIndexes(HTIndexSet* indexes)
+{
+    if(indexes->lastIndex() >= static_cast<ssize_t>(_data.size()))
+    {
+        throw HTException("Index out of range");
+    }
+
+    HTArray* array = HTArray::createWithCapacity(indexes->count());
+    indexes->enumerateIndexes([this, array](size_t index, bool* stop) {
+        array->_data.push_back(_data[index]);
+    });
+    return array;
+}
+
+HTIndexSet* HTArray::indexesOfObjectsPassingTest(const std::function<bool(HTRef* object, size_t index, bool* stop)>& test)
+{
+    HTIndexSet* indexes = HTIndexSet::create();
+    bool stop = false;
+    for(size_t index = 0; index < _data.size() && !stop; ++index)
+    {
+        if(test(_data[index].get(), index, &stop))
+        {
+            indexes->addIndex(index);
+        }
+    }
+    return indexes;
+}
+
 bool HTArray::containsObject(HTRef* object) const
 {
     ssize_t index = getIndexOfObject(object);
@@ -236,6 +266,36 @@ void HTArray::removeLastObject()
     _data.pop_back();
 }
 
+void HTArray::removeObjectsAtIndexes(HTIndexSet* indexes)
+{
+    if(indexes->lastIndex() >= static_cast<ssize_t>(_data.size()))
+    {
+        throw HTException("Index out of range");
+    }
+
+    // Shift the kept elements down between removed indexes
+    size_t write = 0;
+    size_t read = 0;
+    indexes->enumerateIndexes([this, &write, &read](size_t index, bool* stop) {
+        for(; read < index; ++read, ++write)
+        {
+            if(read != write)
+            {
+                _data[write] = std::move(_data[read]);
+            }
+        }
+        read = index + 1;
+    });
+    for(; read < _data.size(); ++read, ++write)
+    {
+        if(read != write)
+        {
+            _data[write] = std::move(_data[read]);
+        }
+    }
+    _data.resize(write);
+}
+
 HTArray* HTArray::clone() const
 {
     HTArray* ret = new HTArray();
@@ -262,4 +322,18 @@ HTArray* HTArray::clone() const
     return ret;
 }
 
+HTDescriptionKind HTArray::getDescriptionKind() const
+{
+    return kHTDescriptionList;
+}
+
+void HTArray::getDescriptionElements(std::vector<HTRef*>& elements) const
+{
+    elements.reserve(elements.size() + _data.size());
+    for(const auto& object: _data)
+    {
+        elements.push_back(object.get());
+    }
+}
+
 NS_HT_END(Huta)
\ No newline at end of file
@@ -0,0 +1,278 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTBloomFilter.h>
+#include <Core/HTHash.h>
+#include <Core/HTString.h>
+#include <Core/HTStringSlice.h>
+#include <Core/HTData.h>
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+NS_HT_BEGIN(Huta)
+
+static const size_t kWordsPerBlock = 8;
+
+static const unsigned char kMagic[4] = { 'H', 'T', 'B', 'F' };
+static const unsigned char kVersion = 2;
+static const size_t kHeaderSize = sizeof(kMagic) + 1 + 8;
+
+// Strings, slices and data hash with this fixed seed instead of the process seed of their
+// hash(), so that a serialized filter of strings works in every process. Version 1 filters
+// hashed strings with FNV-1a and are rejected
+static const uint64_t kFilterSeed = 0x2f8b5c93d1a6e047ULL;
+
+static size_t hashOfObject(HTRef* object)
+{
+    const HTString* string = dynamic_cast<const HTString*>(object);
+    if(string != nullptr)
+    {
+        return static_cast<size_t>(HTHash::hashBytes(string->getCString(), string->length(), kFilterSeed));
+    }
+    const HTStringSlice* slice = dynamic_cast<const HTStringSlice*>(object);
+    if(slice != nullptr)
+    {
+        return static_cast<size_t>(HTHash::hashBytes(slice->getCharacters(), slice->length(), kFilterSeed));
+    }
+    const HTData* data = dynamic_cast<const HTData*>(object);
+    if(data != nullptr)
+    {
+        return static_cast<size_t>(HTHash::hashBytes(data->getBytes(), data->length(), kFilterSeed));
+    }
+    return HTRefHasher()(object);
+}
+
+// Odd constants, one per word of a block, picking the bit set in that word
+static const uint32_t kSalts[kWordsPerBlock] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+HTBloomFilter* HTBloomFilter::createWithCapacity(size_t expectedCount, double falsePositiveRate)
+{
+    HTBloomFilter* filter = new HTBloomFilter();
+    if(filter && filter->initWithCapacity(expectedCount, falsePositiveRate))
+    {
+        filter->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(filter);
+    }
+    return filter;
+}
+
+HTBloomFilter* HTBloomFilter::createWithSet(HTSet* set, double falsePositiveRate)
+{
+    HTBloomFilter* filter = createWithCapacity(set->count(), falsePositiveRate);
+    if(filter)
+    {
+        for(HTRef* object: *set)
+        {
+            filter->addObject(object);
+        }
+    }
+    return filter;
+}
+
+HTBloomFilter* HTBloomFilter::createWithArray(HTArray* array, double falsePositiveRate)
+{
+    HTBloomFilter* filter = createWithCapacity(array->count(), falsePositiveRate);
+    if(filter)
+    {
+        for(auto it = array->begin(); it != array->end(); ++it)
+        {
+            filter->addObject(it->get());
+        }
+    }
+    return filter;
+}
+
+HTBloomFilter* HTBloomFilter::createWithBytes(const std::vector<unsigned char>& bytes)
+{
+    if(bytes.size() < kHeaderSize || !std::equal(kMagic, kMagic + sizeof(kMagic), bytes.begin()) ||
+       bytes[sizeof(kMagic)] != kVersion)
+    {
+        return nullptr;
+    }
+
+    uint64_t blockCount = 0;
+    for(size_t i = 0; i < 8; ++i)
+    {
+        blockCount |= static_cast<uint64_t>(bytes[sizeof(kMagic) + 1 + i]) << (8 * i);
+    }
+    if(blockCount == 0 || (bytes.size() - kHeaderSize) / (kWordsPerBlock * 4) != blockCount ||
+       (bytes.size() - kHeaderSize) % (kWordsPerBlock * 4) != 0)
+    {
+        return nullptr;
+    }
+
+    HTBloomFilter* filter = new HTBloomFilter();
+    filter->autorelease();
+    filter->_blockCount = static_cast<size_t>(blockCount);
+    filter->_words.resize(filter->_blockCount * kWordsPerBlock);
+
+    const unsigned char* p = bytes.data() + kHeaderSize;
+    for(auto& word: filter->_words)
+    {
+        word = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        p += 4;
+    }
+    return filter;
+}
+
+HTBloomFilter::HTBloomFilter()
+: _blockCount(0)
+{
+
+}
+
+HTBloomFilter::~HTBloomFilter()
+{
+
+}
+
+bool HTBloomFilter::initWithCapacity(size_t expectedCount, double falsePositiveRate)
+{
+    if(!(falsePositiveRate > 0.0 && falsePositiveRate < 1.0))
+    {
+        return false;
+    }
+
+    // Bits of a classic filter with one hash per word: m = -k * n / ln(1 - p^(1/k)).
+    // Blocking costs some accuracy, a tenth more room brings the rate back on target
+    double k = static_cast<double>(kWordsPerBlock);
+    double n = static_cast<double>(std::max<size_t>(expectedCount, 1));
+    double bits = -k * n / std::log(1.0 - std::pow(falsePositiveRate, 1.0 / k)) * 1.1;
+    _blockCount = std::max<size_t>(1, static_cast<size_t>(std::ceil(bits / (kWordsPerBlock * 32))));
+    _words.assign(_blockCount * kWordsPerBlock, 0);
+    return true;
+}
+
+// Map the high half of the hash onto the block range without a division
+size_t HTBloomFilter::blockOf(uint64_t hash) const
+{
+    return static_cast<size_t>(((hash >> 32) * static_cast<uint64_t>(_blockCount)) >> 32);
+}
+
+void HTBloomFilter::addObject(HTRef* object)
+{
+    if(object)
+    {
+        addHash(hashOfObject(object));
+    }
+}
+
+void HTBloomFilter::addHash(size_t hash)
+{
+    uint64_t mixed = HTHash::mix(static_cast<uint64_t>(hash));
+    uint32_t key = static_cast<uint32_t>(mixed);
+    uint32_t* block = &_words[blockOf(mixed) * kWordsPerBlock];
+    for(size_t i = 0; i < kWordsPerBlock; ++i)
+    {
+        block[i] |= 1U << ((key * kSalts[i]) >> 27);
+    }
+}
+
+bool HTBloomFilter::mightContainObject(HTRef* object) const
+{
+    return object != nullptr && mightContainHash(hashOfObject(object));
+}
+
+bool HTBloomFilter::mightContainHash(size_t hash) const
+{
+    uint64_t mixed = HTHash::mix(static_cast<uint64_t>(hash));
+    uint32_t key = static_cast<uint32_t>(mixed);
+    const uint32_t* block = &_words[blockOf(mixed) * kWordsPerBlock];
+
+#if defined(__AVX2__)
+    const __m256i salts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kSalts));
+    __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)), salts), 27);
+    __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+    __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    return _mm256_testc_si256(words, mask) != 0;
+#else
+    uint32_t missing = 0;
+    for(size_t i = 0; i < kWordsPerBlock; ++i)
+    {
+        missing |= ~block[i] & (1U << ((key * kSalts[i]) >> 27));
+    }
+    return missing == 0;
+#endif
+}
+
+bool HTBloomFilter::mergeFilter(HTBloomFilter* other)
+{
+    if(other->_blockCount != _blockCount)
+    {
+        return false;
+    }
+
+    uint32_t* words = _words.data();
+    const uint32_t* otherWords = other->_words.data();
+    for(size_t i = 0, n = _words.size(); i < n; ++i)
+    {
+        words[i] |= otherWords[i];
+    }
+    return true;
+}
+
+void HTBloomFilter::removeAllObjects()
+{
+    std::fill(_words.begin(), _words.end(), 0);
+}
+
+size_t HTBloomFilter::getByteSize() const
+{
+    return _words.size() * sizeof(uint32_t);
+}
+
+// Magic, version, little endian block count, then little endian words
+std::vector<unsigned char> HTBloomFilter::getBytes() const
+{
+    std::vector<unsigned char> bytes;
+    bytes.reserve(kHeaderSize + _words.size() * 4);
+    bytes.insert(bytes.end(), kMagic, kMagic + sizeof(kMagic));
+    bytes.push_back(kVersion);
+
+    uint64_t blockCount = static_cast<uint64_t>(_blockCount);
+    for(size_t i = 0; i < 8; ++i)
+    {
+        bytes.push_back(static_cast<unsigned char>(blockCount >> (8 * i)));
+    }
+    for(auto word: _words)
+    {
+        bytes.push_back(static_cast<unsigned char>(word));
+        bytes.push_back(static_cast<unsigned char>(word >> 8));
+        bytes.push_back(static_cast<unsigned char>(word >> 16));
+        bytes.push_back(static_cast<unsigned char>(word >> 24));
+    }
+    return bytes;
+}
+
+NS_HT_END(Huta)
@@ -0,0 +1,343 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTCache.h>
+#include <MultiThread/HTSynchronized.h>
+
+#include <list>
+#include <unordered_map>
+#include <thread>
+#include <algorithm>
+
+NS_HT_BEGIN(Huta)
+
+// Fewest entries a shard is given when there is a count limit
+static const size_t kMinimumShardCountLimit = 8;
+
+struct HTCacheEntry
+{
+    HTRefPtr<HTRef> key;
+    HTRefPtr<HTRef> object;
+    size_t cost;
+};
+
+// Recency list, most recently used first, and an index into it
+struct HTCacheShard
+{
+    HTCacheShard()
+    : totalCost(0)
+    , countLimit(0)
+    , costLimit(0)
+    , hits(0)
+    , misses(0)
+    , evictions(0)
+    {}
+
+    // Move entries over the limits to evicted, the caller holds the lock
+    void evict(std::vector<HTCacheEntry>& evicted)
+    {
+        while(!entries.empty() &&
+              ((countLimit > 0 && entries.size() > countLimit) || (costLimit > 0 && totalCost > costLimit)))
+        {
+            HTCacheEntry& last = entries.back();
+            index.erase(last.key.get());
+            totalCost -= last.cost;
+            evicted.push_back(std::move(last));
+            entries.pop_back();
+            ++evictions;
+        }
+    }
+
+    HTMutex mutex;
+    std::list<HTCacheEntry> entries;
+    std::unordered_map<HTRef*, std::list<HTCacheEntry>::iterator, HTRefHasher, HTRefEqual> index;
+    size_t totalCost;
+    size_t countLimit;
+    size_t costLimit;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
+HTCache* HTCache::create()
+{
+    return createWithLimits(0, 0, 0);
+}
+
+HTCache* HTCache::createWithLimits(size_t countLimit, size_t costLimit, size_t shardCount)
+{
+    HTCache* object = new HTCache();
+    if(object && object->initWithLimits(countLimit, costLimit, shardCount))
+    {
+        object->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(object);
+    }
+    return object;
+}
+
+HTCache::HTCache()
+: _shardShift(0)
+{
+
+}
+
+HTCache::~HTCache()
+{
+
+}
+
+bool HTCache::initWithLimits(size_t countLimit, size_t costLimit, size_t shardCount)
+{
+    if(shardCount == 0)
+    {
+        shardCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // Shards are picked by the high bits of the key hash
+    unsigned int bits = 0;
+    while((static_cast<size_t>(1) << bits) < shardCount)
+    {
+        ++bits;
+    }
+    shardCount = static_cast<size_t>(1) << bits;
+
+    // Each shard evicts on its own once its part of the limit is full. A small count limit
+    // split over many shards would leave every shard room for a single entry, so fewer
+    // shards are used until each holds at least kMinimumShardCountLimit entries
+    while(countLimit > 0 && bits > 0 && countLimit / shardCount < kMinimumShardCountLimit)
+    {
+        --bits;
+        shardCount >>= 1;
+    }
+    _shardShift = sizeof(size_t) * 8 - bits;
+
+    _shards.clear();
+    for(size_t i = 0; i < shardCount; ++i)
+    {
+        HTCacheShard* shard = new HTCacheShard();
+        shard->countLimit = countLimit > 0 ? std::max<size_t>(1, (countLimit + shardCount - 1) / shardCount) : 0;
+        shard->costLimit = costLimit > 0 ? std::max<size_t>(1, (costLimit + shardCount - 1) / shardCount) : 0;
+        _shards.push_back(std::unique_ptr<HTCacheShard>(shard));
+    }
+    return true;
+}
+
+HTCacheShard& HTCache::shardForKey(HTRef* key)
+{
+    size_t hash = HTRefHasher()(key);
+    if(_shards.size() == 1)
+    {
+        return *_shards[0];
+    }
+
+    // Spread the hash first, the shard index must not follow the bucket index
+    uint64_t x = static_cast<uint64_t>(hash) * 0x9e3779b97f4a7c15ULL;
+    return *_shards[static_cast<size_t>(x) >> _shardShift];
+}
+
+HTRefPtr<HTRef> HTCache::objectForKey(HTRef* key)
+{
+    HTRefPtr<HTRef> object;
+    if(key == nullptr)
+    {
+        return object;
+    }
+
+    HTCacheShard& shard = shardForKey(key);
+    synchronized(shard.mutex)
+    {
+        auto it = shard.index.find(key);
+        if(it == shard.index.end())
+        {
+            ++shard.misses;
+        }
+        else
+        {
+            ++shard.hits;
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            object = it->second->object;
+        }
+    }
+    return object;
+}
+
+void HTCache::setObject(HTRef* object, HTRef* key)
+{
+    setObject(object, key, 0);
+}
+
+void HTCache::setObject(HTRef* object, HTRef* key, size_t cost)
+{
+    if(object == nullptr || key == nullptr)
+    {
+        return;
+    }
+
+    std::vector<HTCacheEntry> evicted;
+    HTCacheEntry replaced;
+    HTCacheShard& shard = shardForKey(key);
+    synchronized(shard.mutex)
+    {
+        auto it = shard.index.find(key);
+        if(it != shard.index.end())
+        {
+            // Keep the old object alive until the lock is released
+            HTCacheEntry& entry = *it->second;
+            replaced.object = entry.object;
+            shard.totalCost = shard.totalCost - entry.cost + cost;
+            entry.object = object;
+            entry.cost = cost;
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        }
+        else
+        {
+            HTCacheEntry entry;
+            entry.key = key;
+            entry.object = object;
+            entry.cost = cost;
+            shard.entries.push_front(std::move(entry));
+            shard.index[key] = shard.entries.begin();
+            shard.totalCost += cost;
+        }
+        shard.evict(evicted);
+    }
+
+    if(_evictionCallback)
+    {
+        for(auto& entry: evicted)
+        {
+            _evictionCallback(entry.key.get(), entry.object.get());
+        }
+    }
+}
+
+void HTCache::removeObjectForKey(HTRef* key)
+{
+    if(key == nullptr)
+    {
+        return;
+    }
+
+    HTCacheEntry removed;
+    HTCacheShard& shard = shardForKey(key);
+    synchronized(shard.mutex)
+    {
+        auto it = shard.index.find(key);
+        if(it != shard.index.end())
+        {
+            auto entry = it->second;
+            shard.index.erase(it);
+            shard.totalCost -= entry->cost;
+            removed = std::move(*entry);
+            shard.entries.erase(entry);
+        }
+    }
+}
+
+void HTCache::removeAllObjects()
+{
+    for(auto& shard: _shards)
+    {
+        std::list<HTCacheEntry> removed;
+        synchronized(shard->mutex)
+        {
+            shard->index.clear();
+            shard->entries.swap(removed);
+            shard->totalCost = 0;
+        }
+    }
+}
+
+void HTCache::setEvictionCallback(const EvictionCallback& callback)
+{
+    _evictionCallback = callback;
+}
+
+size_t HTCache::count() const
+{
+    size_t count = 0;
+    for(auto& shard: _shards)
+    {
+        synchronized(shard->mutex)
+        {
+            count += shard->entries.size();
+        }
+    }
+    return count;
+}
+
+size_t HTCache::totalCost() const
+{
+    size_t cost = 0;
+    for(auto& shard: _shards)
+    {
+        synchronized(shard->mutex)
+        {
+            cost += shard->totalCost;
+        }
+    }
+    return cost;
+}
+
+uint64_t HTCache::hitCount() const
+{
+    uint64_t hits = 0;
+    for(auto& shard: _shards)
+    {
+        synchronized(shard->mutex)
+        {
+            hits += shard->hits;
+        }
+    }
+    return hits;
+}
+
+uint64_t HTCache::missCount() const
+{
+    uint64_t misses = 0;
+    for(auto& shard: _shards)
+    {
+        synchronized(shard->mutex)
+        {
+            misses += shard->misses;
+        }
+    }
+    return misses;
+}
+
+uint64_t HTCache::evictionCount() const
+{
+    uint64_t evictions = 0;
+    for(auto& shard: _shards)
+    {
+        synchronized(shard->mutex)
+        {
+            evictions += shard->evictions;
+        }
+    }
+    return evictions;
+}
+
+NS_HT_END(Huta)
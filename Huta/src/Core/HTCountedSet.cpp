@@ -0,0 +1,438 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTCountedSet.h>
+#include <Core/HTHash.h>
+#include <MultiThread/HTThread.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+
+NS_HT_BEGIN(Huta)
+
+static const size_t kMinCapacity = 8;
+
+static const unsigned int kHashBits = sizeof(size_t) * 8;
+
+static inline size_t slotHash(const HTObject* object)
+{
+    return static_cast<size_t>(HTHash::mix(static_cast<uint64_t>(object->hash())));
+}
+
+//--------------------------------------------------------------------
+//
+// Table
+//
+//--------------------------------------------------------------------
+
+HTCountedSet::Table::Table()
+: count(0)
+, shift(kHashBits)
+{
+
+}
+
+HTCountedSet::Slot* HTCountedSet::Table::find(size_t hash, const HTObject* object) const
+{
+    if(count == 0)
+    {
+        return nullptr;
+    }
+
+    size_t mask = slots.size() - 1;
+    for(size_t index = hash >> shift; ; index = (index + 1) & mask)
+    {
+        const Slot& slot = slots[index];
+        if(slot.object == nullptr)
+        {
+            return nullptr;
+        }
+        if(slot.hash == hash && (slot.object == object || slot.object->isEqual(object)))
+        {
+            return const_cast<Slot*>(&slot);
+        }
+    }
+}
+
+HTCountedSet::Slot* HTCountedSet::Table::findOrInsert(size_t hash, HTObject* object, bool& inserted)
+{
+    reserve(count + 1);
+
+    size_t mask = slots.size() - 1;
+    for(size_t index = hash >> shift; ; index = (index + 1) & mask)
+    {
+        Slot& slot = slots[index];
+        if(slot.object == nullptr)
+        {
+            slot.hash = hash;
+            slot.object = object;
+            slot.count = 0;
+            ++count;
+            inserted = true;
+            return &slot;
+        }
+        if(slot.hash == hash && (slot.object == object || slot.object->isEqual(object)))
+        {
+            inserted = false;
+            return &slot;
+        }
+    }
+}
+
+// Backward shift deletion, no tombstones are left behind
+void HTCountedSet::Table::erase(Slot* slot)
+{
+    size_t mask = slots.size() - 1;
+    size_t hole = slot - slots.data();
+    for(size_t next = (hole + 1) & mask; slots[next].object != nullptr; next = (next + 1) & mask)
+    {
+        size_t home = slots[next].hash >> shift;
+        if(((next - home) & mask) >= ((next - hole) & mask))
+        {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+    }
+    slots[hole] = Slot{ 0, nullptr, 0 };
+    --count;
+}
+
+// Keep the load factor at most 3/4
+void HTCountedSet::Table::reserve(size_t minimum)
+{
+    if(!slots.empty() && minimum * 4 <= slots.size() * 3)
+    {
+        return;
+    }
+
+    size_t capacity = kMinCapacity;
+    unsigned int bits = 3;
+    while(minimum * 4 > capacity * 3)
+    {
+        capacity <<= 1;
+        ++bits;
+    }
+    if(capacity <= slots.size())
+    {
+        return;
+    }
+
+    std::vector<Slot> old(capacity, Slot{ 0, nullptr, 0 });
+    old.swap(slots);
+    shift = kHashBits - bits;
+
+    size_t mask = capacity - 1;
+    for(auto& slot: old)
+    {
+        if(slot.object)
+        {
+            size_t index = slot.hash >> shift;
+            while(slots[index].object != nullptr)
+            {
+                index = (index + 1) & mask;
+            }
+            slots[index] = slot;
+        }
+    }
+}
+
+//--------------------------------------------------------------------
+//
+// HTCountedSet
+//
+//--------------------------------------------------------------------
+
+HTCountedSet::HTCountedSet()
+: _totalCount(0)
+{
+
+}
+
+HTCountedSet::~HTCountedSet()
+{
+    removeAllObjects();
+}
+
+HTCountedSet* HTCountedSet::create()
+{
+    HTCountedSet* ret = new HTCountedSet();
+    if(ret)
+    {
+        ret->autorelease();
+    }
+    return ret;
+}
+
+HTCountedSet* HTCountedSet::createWithCapacity(size_t capacity)
+{
+    HTCountedSet* ret = HTCountedSet::create();
+    if(ret)
+    {
+        ret->_table.reserve(capacity);
+    }
+    return ret;
+}
+
+HTCountedSet* HTCountedSet::createByMergingCountedSets(const std::vector<HTCountedSet*>& sets, size_t threadCount)
+{
+    if(threadCount == 0)
+    {
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    size_t distinct = 0;
+    for(auto set: sets)
+    {
+        distinct = std::max(distinct, set->count());
+    }
+
+    // Equal objects have equal hashes, so partitions never share an object and the
+    // worker threads neither touch reference counts nor each other's tables
+    std::vector<Table> partitions(threadCount);
+    {
+        std::vector< HTRefPtr<HTThread> > workers;
+        for(size_t part = 0; part < threadCount; ++part)
+        {
+            Table* table = &partitions[part];
+            table->reserve(distinct / threadCount);
+
+            HTThread* thread = new HTThread([&sets, table, part, threadCount] {
+                bool inserted = false;
+                for(auto set: sets)
+                {
+                    for(auto& slot: set->_table.slots)
+                    {
+                        if(slot.object && slot.hash % threadCount == part)
+                        {
+                            table->findOrInsert(slot.hash, slot.object, inserted)->count += slot.count;
+                        }
+                    }
+                }
+            });
+            workers.push_back(HTRefPtr<HTThread>(thread));
+            thread->release();
+        }
+        // Releasing the threads joins them
+    }
+
+    size_t total = 0;
+    for(auto& table: partitions)
+    {
+        total += table.count;
+    }
+
+    HTCountedSet* ret = HTCountedSet::createWithCapacity(total);
+    bool inserted = false;
+    for(auto& table: partitions)
+    {
+        for(auto& slot: table.slots)
+        {
+            if(slot.object)
+            {
+                ret->_table.findOrInsert(slot.hash, slot.object, inserted)->count = slot.count;
+                ret->_totalCount += slot.count;
+                slot.object->retain();
+            }
+        }
+    }
+    return ret;
+}
+
+size_t HTCountedSet::count() const
+{
+    return _table.count;
+}
+
+size_t HTCountedSet::totalCount() const
+{
+    return _totalCount;
+}
+
+void HTCountedSet::addObject(HTObject* object)
+{
+    addObject(object, 1);
+}
+
+void HTCountedSet::addObject(HTObject* object, size_t times)
+{
+    if(object == nullptr || times == 0)
+    {
+        return;
+    }
+
+    bool inserted = false;
+    Slot* slot = _table.findOrInsert(slotHash(object), object, inserted);
+    if(inserted)
+    {
+        object->retain();
+    }
+    slot->count += times;
+    _totalCount += times;
+}
+
+void HTCountedSet::removeObject(HTObject* object)
+{
+    if(object == nullptr)
+    {
+        return;
+    }
+
+    Slot* slot = _table.find(slotHash(object), object);
+    if(slot == nullptr)
+    {
+        return;
+    }
+
+    --_totalCount;
+    if(--slot->count == 0)
+    {
+        HTObject* stored = slot->object;
+        _table.erase(slot);
+        stored->release();
+    }
+}
+
+void HTCountedSet::removeAllObjects()
+{
+    Table table;
+    std::swap(table, _table);
+    _totalCount = 0;
+
+    for(auto& slot: table.slots)
+    {
+        HT_SAFE_RELEASE(slot.object);
+    }
+}
+
+size_t HTCountedSet::countForObject(HTObject* object) const
+{
+    if(object == nullptr)
+    {
+        return 0;
+    }
+
+    Slot* slot = _table.find(slotHash(object), object);
+    return slot ? slot->count : 0;
+}
+
+bool HTCountedSet::containsObject(HTObject* object) const
+{
+    return countForObject(object) > 0;
+}
+
+void HTCountedSet::unionCountedSet(HTCountedSet* other)
+{
+    if(other == this)
+    {
+        for(auto& slot: _table.slots)
+        {
+            slot.count *= 2;
+        }
+        _totalCount *= 2;
+        return;
+    }
+
+    _table.reserve(_table.count + other->_table.count);
+    bool inserted = false;
+    for(auto& slot: other->_table.slots)
+    {
+        if(slot.object)
+        {
+            Slot* own = _table.findOrInsert(slot.hash, slot.object, inserted);
+            if(inserted)
+            {
+                slot.object->retain();
+            }
+            own->count += slot.count;
+            _totalCount += slot.count;
+        }
+    }
+}
+
+HTArray* HTCountedSet::topObjects(size_t k) const
+{
+    std::vector<const Slot*> slots;
+    slots.reserve(_table.count);
+    for(auto& slot: _table.slots)
+    {
+        if(slot.object)
+        {
+            slots.push_back(&slot);
+        }
+    }
+
+    k = std::min(k, slots.size());
+    std::partial_sort(slots.begin(), slots.begin() + k, slots.end(), [](const Slot* a, const Slot* b) {
+        return a->count > b->count;
+    });
+
+    HTArray* array = HTArray::createWithCapacity(k);
+    for(size_t i = 0; i < k; ++i)
+    {
+        array->addObject(slots[i]->object);
+    }
+    return array;
+}
+
+HTArray* HTCountedSet::allObjects() const
+{
+    HTArray* array = HTArray::createWithCapacity(_table.count);
+    for(auto& slot: _table.slots)
+    {
+        if(slot.object)
+        {
+            array->addObject(slot.object);
+        }
+    }
+    return array;
+}
+
+void HTCountedSet::enumerateObjectsAndCounts(const std::function<void(HTRef* object, size_t count, bool* stop)>& callback) const
+{
+    bool stop = false;
+    for(auto it = _table.slots.begin(); it != _table.slots.end() && !stop; ++it)
+    {
+        if(it->object)
+        {
+            callback(it->object, it->count, &stop);
+        }
+    }
+}
+
+HTDescriptionKind HTCountedSet::getDescriptionKind() const
+{
+    return kHTDescriptionSet;
+}
+
+void HTCountedSet::getDescriptionElements(std::vector<HTRef*>& elements) const
+{
+    for(const auto& slot: _table.slots)
+    {
+        if(slot.object)
+        {
+            elements.push_back(slot.object);
+        }
+    }
+}
+
+NS_HT_END(Huta)
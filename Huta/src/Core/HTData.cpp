@@ -0,0 +1,403 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include <Core/HTData.h>
+#include <Core/HTOutputSink.h>
+#include <Core/HTException.h>
+#include <Core/HTHash.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+NS_HT_BEGIN(Huta)
+
+enum HTMapResult
+{
+    kMapSuccess,
+    kMapUnsupported,
+    kMapFailure
+};
+
+// Map a whole file read only. Files that can not be mapped report kMapUnsupported so that
+// the caller reads them instead. That includes empty files, there is nothing to map, and
+// files like the ones in /proc that report a size of zero but still have contents
+static HTMapResult mapFile(const std::string& path, void*& bytes, size_t& length, HTData::Deallocator& deallocator)
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        return kMapFailure;
+    }
+
+    LARGE_INTEGER size;
+    if(GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return kMapUnsupported;
+    }
+    if(static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX)
+    {
+        CloseHandle(file);
+        return kMapFailure;
+    }
+    length = static_cast<size_t>(size.QuadPart);
+    if(length == 0)
+    {
+        CloseHandle(file);
+        return kMapUnsupported;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if(mapping == nullptr)
+    {
+        return kMapUnsupported;
+    }
+    bytes = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if(bytes == nullptr)
+    {
+        return kMapUnsupported;
+    }
+    deallocator = [](void* mapped, size_t) { UnmapViewOfFile(mapped); };
+    return kMapSuccess;
+#else
+    int descriptor;
+    do
+    {
+        descriptor = open(path.c_str(), O_RDONLY);
+    }
+    while(descriptor < 0 && errno == EINTR);
+    if(descriptor < 0)
+    {
+        return kMapFailure;
+    }
+
+    struct stat status;
+    if(fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        close(descriptor);
+        return kMapUnsupported;
+    }
+    if(static_cast<unsigned long long>(status.st_size) > SIZE_MAX)
+    {
+        close(descriptor);
+        return kMapFailure;
+    }
+    length = static_cast<size_t>(status.st_size);
+    if(length == 0)
+    {
+        close(descriptor);
+        return kMapUnsupported;
+    }
+
+    // The mapping keeps its own reference to the file, the descriptor is not needed after
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if(address == MAP_FAILED)
+    {
+        return kMapUnsupported;
+    }
+    bytes = address;
+    deallocator = [](void* mapped, size_t size) { munmap(mapped, size); };
+    return kMapSuccess;
+#endif
+}
+
+// Read a whole file into one malloc buffer, growing it for files of unknown size
+static bool readFile(const std::string& path, void*& bytes, size_t& length)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if(file == nullptr)
+    {
+        return false;
+    }
+
+    size_t capacity = 64 * 1024;
+    size_t count = 0;
+    unsigned char* buffer = static_cast<unsigned char*>(malloc(capacity));
+    while(buffer != nullptr)
+    {
+        count += fread(buffer + count, 1, capacity - count, file);
+        if(count < capacity)
+        {
+            break;
+        }
+        unsigned char* grown = static_cast<unsigned char*>(realloc(buffer, capacity * 2));
+        if(grown == nullptr)
+        {
+            free(buffer);
+            buffer = nullptr;
+            break;
+        }
+        buffer = grown;
+        capacity *= 2;
+    }
+
+    bool failed = buffer == nullptr || ferror(file) != 0;
+    fclose(file);
+    if(failed)
+    {
+        free(buffer);
+        return false;
+    }
+    bytes = buffer;
+    length = count;
+    return true;
+}
+
+HTData* HTData::create()
+{
+    return createWithBytes(nullptr, 0);
+}
+
+HTData* HTData::createWithBytes(const void* bytes, size_t length)
+{
+    HTData* data = new HTData();
+    if(data && data->initWithBytes(bytes, length))
+    {
+        data->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(data);
+    }
+    return data;
+}
+
+HTData* HTData::createWithBytesNoCopy(void* bytes, size_t length, bool freeWhenDone)
+{
+    if(freeWhenDone)
+    {
+        return createWithDeallocator(bytes, length, [](void* buffer, size_t) { free(buffer); });
+    }
+    return createWithDeallocator(bytes, length, Deallocator());
+}
+
+HTData* HTData::createWithDeallocator(void* bytes, size_t length, const Deallocator& deallocator)
+{
+    HTData* data = new HTData();
+    if(data && data->initWithBytesNoCopy(bytes, length, deallocator))
+    {
+        data->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(data);
+    }
+    return data;
+}
+
+HTData* HTData::createWithContentsOfFile(const std::string& path, bool mapped)
+{
+    HTData* data = new HTData();
+    if(data && data->initWithContentsOfFile(path, mapped))
+    {
+        data->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(data);
+    }
+    return data;
+}
+
+HTData::HTData()
+: _bytes(nullptr)
+, _length(0)
+, _parent(nullptr)
+, _mapped(false)
+, _hash(0)
+, _hasHash(false)
+{
+
+}
+
+HTData::~HTData()
+{
+    if(_deallocator && _bytes != nullptr)
+    {
+        _deallocator(const_cast<unsigned char*>(_bytes), _length);
+    }
+    HT_SAFE_RELEASE(_parent);
+}
+
+bool HTData::initWithBytes(const void* bytes, size_t length)
+{
+    if(length == 0)
+    {
+        return initWithBytesNoCopy(nullptr, 0, Deallocator());
+    }
+    if(bytes == nullptr)
+    {
+        return false;
+    }
+
+    void* copy = malloc(length);
+    if(copy == nullptr)
+    {
+        return false;
+    }
+    memcpy(copy, bytes, length);
+    return initWithBytesNoCopy(copy, length, [](void* buffer, size_t) { free(buffer); });
+}
+
+bool HTData::initWithBytesNoCopy(void* bytes, size_t length, const Deallocator& deallocator)
+{
+    if(bytes == nullptr && length > 0)
+    {
+        return false;
+    }
+
+    // Empty data always points at valid memory, so getBytes() never returns nullptr
+    static const unsigned char kEmpty[1] = { 0 };
+    _bytes = bytes != nullptr ? static_cast<const unsigned char*>(bytes) : kEmpty;
+    _length = length;
+    _deallocator = bytes != nullptr ? deallocator : Deallocator();
+    return true;
+}
+
+bool HTData::initWithContentsOfFile(const std::string& path, bool mapped)
+{
+    void* bytes = nullptr;
+    size_t length = 0;
+    Deallocator deallocator;
+    if(mapped)
+    {
+        HTMapResult result = mapFile(path, bytes, length, deallocator);
+        if(result == kMapFailure)
+        {
+            return false;
+        }
+        if(result == kMapSuccess)
+        {
+            _mapped = true;
+            return initWithBytesNoCopy(bytes, length, deallocator);
+        }
+    }
+
+    if(!readFile(path, bytes, length))
+    {
+        return false;
+    }
+    if(length == 0)
+    {
+        free(bytes);
+        bytes = nullptr;
+    }
+    return initWithBytesNoCopy(bytes, length, [](void* buffer, size_t) { free(buffer); });
+}
+
+bool HTData::isMapped() const
+{
+    return _mapped || (_parent != nullptr && _parent->isMapped());
+}
+
+unsigned char HTData::byteAtIndex(size_t index) const
+{
+    if(index >= _length)
+    {
+        throw HTException("Index out of range");
+    }
+    return _bytes[index];
+}
+
+HTData* HTData::subdataWithRange(size_t offset, size_t length) const
+{
+    if(offset > _length || length > _length - offset)
+    {
+        throw HTException("Range out of bounds");
+    }
+
+    // Slices hold on to the data that owns the bytes, never to another slice
+    HTData* owner = _parent != nullptr ? _parent : const_cast<HTData*>(this);
+    HTData* data = new HTData();
+    data->autorelease();
+    data->_bytes = _bytes + offset;
+    data->_length = length;
+    data->_parent = owner;
+    owner->retain();
+    return data;
+}
+
+bool HTData::isEqualToData(const HTData* other) const
+{
+    if(other == this)
+    {
+        return true;
+    }
+    if(other == nullptr || other->_length != _length)
+    {
+        return false;
+    }
+    if(other->_bytes == _bytes)
+    {
+        return true;
+    }
+
+    // Comparing hashes that are already known rules out most different data of one length
+    if(_hasHash.load(std::memory_order_acquire) && other->_hasHash.load(std::memory_order_acquire) &&
+       _hash.load(std::memory_order_relaxed) != other->_hash.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    return memcmp(_bytes, other->_bytes, _length) == 0;
+}
+
+bool HTData::isEqual(const HTObject* object)
+{
+    return isEqualToData(dynamic_cast<const HTData*>(object));
+}
+
+size_t HTData::hash() const
+{
+    if(_hasHash.load(std::memory_order_acquire))
+    {
+        return _hash.load(std::memory_order_relaxed);
+    }
+
+    size_t value = static_cast<size_t>(HTHash::hashBytesSeeded(_bytes, _length));
+    _hash.store(value, std::memory_order_relaxed);
+    _hasHash.store(true, std::memory_order_release);
+    return value;
+}
+
+void HTData::describeSelfTo(HTOutputSink& sink) const
+{
+    sink.appendCharacter('<');
+    sink.appendValue(_length);
+    sink.append(" bytes>", 7);
+}
+
+NS_HT_END(Huta)
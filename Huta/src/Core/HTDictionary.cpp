@@ -21,6 +21,7 @@
 // THE SOFTWARE.
 
 #include <Core/HTDictionary.h>
+#include <Core/HTString.h>
 
 NS_HT_BEGIN(Huta)
 
@@ -60,15 +61,15 @@ bool HTDictionary::init()
     return true;
 }
 
-size_t HTDictionary::count()
+size_t HTDictionary::count() const
 {
     return _map.size();
 }
 
 HTArray* HTDictionary::allKeys()
 {
-    HTArray* array = HTArray::create();
-    for(auto it: _map)
+    HTArray* array = HTArray::createWithCapacity(_map.size());
+    for(const auto& it: _map)
     {
         array->addObject(it.first.get());
     }
@@ -77,18 +78,27 @@ HTArray* HTDictionary::allKeys()
 
 HTArray* HTDictionary::allObjects()
 {
-    HTArray* array = HTArray::create();
-    for(auto it: _map)
+    HTArray* array = HTArray::createWithCapacity(_map.size());
+    for(const auto& it: _map)
     {
         array->addObject(it.second.get());
     }
     return array;
 }
 
+void HTDictionary::enumerateKeysAndObjects(const std::function<void(HTRef* key, HTRef* object, bool* stop)>& callback) const
+{
+    bool stop = false;
+    for(auto it = _map.begin(); it != _map.end() && !stop; ++it)
+    {
+        callback(it->first.get(), it->second.get(), &stop);
+    }
+}
+
 HTRef* HTDictionary::objectForKey(HTRef* key)
 {   
-    HTRefPtr<HTRef> ref = _map[key];
-    return ref.get();
+    auto it = _map.find(key);
+    return it != _map.end() ? it->second.get() : nullptr;
 }
 
 
@@ -99,7 +109,21 @@ void HTDictionary::setObject(HTRef* object, HTRef* key)
         // TODO: throw exception if key or object is nullptr
     }
 
-    _map[HTRefPtr<HTRef>(key)] = HTRefPtr<HTRef>(object);
+    auto it = _map.find(key);
+    if(it != _map.end())
+    {
+        it->second = object;
+        return;
+    }
+
+    // A string can still be appended to after it is inserted, which would change its hash
+    // under the map. Keep a copy instead, interned strings never change
+    HTString* string = dynamic_cast<HTString*>(key);
+    if(string != nullptr && !string->isInterned())
+    {
+        key = string->clone();
+    }
+    _map.emplace(HTRefPtr<HTRef>(key), HTRefPtr<HTRef>(object));
 }
 
 void HTDictionary::removeObjectForKey(HTRef* key)
@@ -123,4 +147,20 @@ HTDictionary* HTDictionary::clone() const
     object->_map = _map;
     return object;
 }
+
+HTDescriptionKind HTDictionary::getDescriptionKind() const
+{
+    return kHTDescriptionMap;
+}
+
+void HTDictionary::getDescriptionElements(std::vector<HTRef*>& elements) const
+{
+    elements.reserve(elements.size() + _map.size() * 2);
+    for(const auto& it: _map)
+    {
+        elements.push_back(it.first.get());
+        elements.push_back(it.second.get());
+    }
+}
+
 NS_HT_END(Huta)
\ No newline at end of file
@@ -0,0 +1,180 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include <Core/HTHash.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+NS_HT_BEGIN(Huta)
+
+static const uint64_t kSecret[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+// Full 128 bit product of a and b, low half in a and high half in b
+static inline void multiply(uint64_t& a, uint64_t& b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(product);
+    b = static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a);
+    uint64_t bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+    uint64_t high = aHigh * bHigh, middle0 = aHigh * bLow, middle1 = aLow * bHigh, low = aLow * bLow;
+    uint64_t t = low + (middle0 << 32);
+    uint64_t carry = t < low;
+    uint64_t lo = t + (middle1 << 32);
+    carry += lo < t;
+    a = lo;
+    b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
+}
+
+// Multiply and fold the two halves of the product together
+static inline uint64_t multiplyFold(uint64_t a, uint64_t b)
+{
+    multiply(a, b);
+    return a ^ b;
+}
+
+// Loads are little endian so that hashes are the same on every machine
+static inline uint64_t read64(const unsigned char* p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+static inline uint64_t read32(const unsigned char* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+// First, middle and last byte of 1 to 3 bytes
+static inline uint64_t read3(const unsigned char* p, size_t length)
+{
+    return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[length >> 1]) << 8) | p[length - 1];
+}
+
+uint64_t HTHash::hashBytes(const void* data, size_t length, uint64_t seed)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    seed ^= multiplyFold(seed ^ kSecret[0], kSecret[1]);
+
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if(length <= 16)
+    {
+        // Two overlapping pairs of 4 byte loads cover 4 to 16 bytes without a loop
+        if(length >= 4)
+        {
+            size_t shift = (length >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + shift);
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - shift);
+        }
+        else if(length > 0)
+        {
+            a = read3(p, length);
+        }
+    }
+    else
+    {
+        size_t remaining = length;
+        if(remaining > 48)
+        {
+            uint64_t lane1 = seed;
+            uint64_t lane2 = seed;
+            do
+            {
+                seed = multiplyFold(read64(p) ^ kSecret[1], read64(p + 8) ^ seed);
+                lane1 = multiplyFold(read64(p + 16) ^ kSecret[2], read64(p + 24) ^ lane1);
+                lane2 = multiplyFold(read64(p + 32) ^ kSecret[3], read64(p + 40) ^ lane2);
+                p += 48;
+                remaining -= 48;
+            }
+            while(remaining > 48);
+            seed ^= lane1 ^ lane2;
+        }
+        while(remaining > 16)
+        {
+            seed = multiplyFold(read64(p) ^ kSecret[1], read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+
+        // The last 16 bytes, which may overlap bytes already hashed
+        a = read64(p + remaining - 16);
+        b = read64(p + remaining - 8);
+    }
+
+    a ^= kSecret[1];
+    b ^= seed;
+    multiply(a, b);
+    return multiplyFold(a ^ kSecret[0] ^ length, b ^ kSecret[1]);
+}
+
+static uint64_t makeProcessSeed()
+{
+    const char* fixed = getenv("HUTA_HASH_SEED");
+    if(fixed != nullptr && fixed[0] != '\0')
+    {
+        char* end = nullptr;
+        unsigned long long value = strtoull(fixed, &end, 0);
+        if(end != nullptr && *end == '\0')
+        {
+            return static_cast<uint64_t>(value);
+        }
+    }
+
+    // random_device may be deterministic or missing on some platforms, the clock and an
+    // address are mixed in so that the seed still changes from run to run
+    uint64_t seed = static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    seed = HTHash::combine(seed, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&seed)));
+    try
+    {
+        std::random_device device;
+        seed = HTHash::combine(seed, (static_cast<uint64_t>(device()) << 32) | device());
+    }
+    catch(...)
+    {
+    }
+    return seed;
+}
+
+uint64_t HTHash::getProcessSeed()
+{
+    static const uint64_t seed = makeProcessSeed();
+    return seed;
+}
+
+NS_HT_END(Huta)
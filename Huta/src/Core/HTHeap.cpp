@@ -0,0 +1,309 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTHeap.h>
+#include <Core/HTArray.h>
+#include <Core/HTException.h>
+
+#include <algorithm>
+#include <utility>
+
+NS_HT_BEGIN(Huta)
+
+const size_t HTHeap::kArity;
+const size_t HTHeap::kNoPosition;
+
+HTHeap* HTHeap::createWithComparator(const Comparator& comparator)
+{
+    HTHeap* object = new HTHeap();
+    if(object && object->initWithComparator(comparator))
+    {
+        object->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(object);
+    }
+    return object;
+}
+
+HTHeap* HTHeap::createWithArray(HTArray* array, const Comparator& comparator)
+{
+    HTHeap* object = new HTHeap();
+    if(object && object->initWithArray(array, comparator))
+    {
+        object->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(object);
+    }
+    return object;
+}
+
+HTHeap::HTHeap()
+{
+
+}
+
+HTHeap::~HTHeap()
+{
+
+}
+
+bool HTHeap::initWithComparator(const Comparator& comparator)
+{
+    if(!comparator)
+    {
+        return false;
+    }
+    _comparator = comparator;
+    removeAllObjects();
+    return true;
+}
+
+bool HTHeap::initWithArray(HTArray* array, const Comparator& comparator)
+{
+    if(!initWithComparator(comparator))
+    {
+        return false;
+    }
+
+    _nodes.reserve(array->count());
+    _positions.reserve(array->count());
+    for(const auto& object: *array)
+    {
+        Node node;
+        node.object = object;
+        node.handle = _positions.size();
+        _positions.push_back(_nodes.size());
+        _nodes.push_back(std::move(node));
+    }
+    heapify();
+    return true;
+}
+
+HTHeap::Handle HTHeap::push(HTRef* object)
+{
+    Handle handle = acquireHandle();
+    Node node;
+    node.object = object;
+    node.handle = handle;
+    _positions[handle] = _nodes.size();
+    _nodes.push_back(std::move(node));
+    siftUp(_nodes.size() - 1);
+    return handle;
+}
+
+HTRef* HTHeap::peek() const
+{
+    return _nodes.empty() ? nullptr : _nodes.front().object.get();
+}
+
+HTRefPtr<HTRef> HTHeap::pop()
+{
+    if(_nodes.empty())
+    {
+        return nullptr;
+    }
+
+    HTRefPtr<HTRef> object = std::move(_nodes.front().object);
+    removeAtPosition(0);
+    return object;
+}
+
+HTRef* HTHeap::getObjectForHandle(Handle handle) const
+{
+    return _nodes[positionOfHandle(handle)].object.get();
+}
+
+bool HTHeap::containsHandle(Handle handle) const
+{
+    return handle < _positions.size() && _positions[handle] != kNoPosition;
+}
+
+void HTHeap::updateObject(Handle handle)
+{
+    size_t position = positionOfHandle(handle);
+    siftUp(position);
+    // Sifting up moved the node if its priority rose, otherwise it may have to go down
+    if(_positions[handle] == position)
+    {
+        siftDown(position);
+    }
+}
+
+void HTHeap::replaceObject(Handle handle, HTRef* object)
+{
+    _nodes[positionOfHandle(handle)].object = object;
+    updateObject(handle);
+}
+
+void HTHeap::removeObject(Handle handle)
+{
+    removeAtPosition(positionOfHandle(handle));
+}
+
+void HTHeap::removeAllObjects()
+{
+    _nodes.clear();
+    _positions.clear();
+    _freeHandles.clear();
+}
+
+HTArray* HTHeap::allObjects() const
+{
+    std::vector<HTRef*> objects;
+    objects.reserve(_nodes.size());
+    for(const auto& node: _nodes)
+    {
+        objects.push_back(node.object.get());
+    }
+    std::stable_sort(objects.begin(), objects.end(), _comparator);
+
+    HTArray* array = HTArray::createWithCapacity(objects.size());
+    for(auto object: objects)
+    {
+        array->addObject(object);
+    }
+    return array;
+}
+
+size_t HTHeap::positionOfHandle(Handle handle) const
+{
+    if(!containsHandle(handle))
+    {
+        throw HTException("Invalid heap handle");
+    }
+    return _positions[handle];
+}
+
+HTHeap::Handle HTHeap::acquireHandle()
+{
+    if(!_freeHandles.empty())
+    {
+        Handle handle = _freeHandles.back();
+        _freeHandles.pop_back();
+        return handle;
+    }
+    _positions.push_back(kNoPosition);
+    return _positions.size() - 1;
+}
+
+void HTHeap::place(Node& node, size_t position)
+{
+    _positions[node.handle] = position;
+    _nodes[position] = std::move(node);
+}
+
+// Both sifts move a hole instead of swapping, each step is one move and one position update
+void HTHeap::siftUp(size_t position)
+{
+    if(position == 0)
+    {
+        return;
+    }
+
+    Node node = std::move(_nodes[position]);
+    while(position > 0)
+    {
+        size_t parent = (position - 1) / kArity;
+        if(!_comparator(node.object.get(), _nodes[parent].object.get()))
+        {
+            break;
+        }
+        place(_nodes[parent], position);
+        position = parent;
+    }
+    place(node, position);
+}
+
+void HTHeap::siftDown(size_t position)
+{
+    size_t size = _nodes.size();
+    Node node = std::move(_nodes[position]);
+    while(true)
+    {
+        size_t first = position * kArity + 1;
+        if(first >= size)
+        {
+            break;
+        }
+
+        size_t last = std::min(first + kArity, size);
+        size_t best = first;
+        for(size_t child = first + 1; child < last; ++child)
+        {
+            if(_comparator(_nodes[child].object.get(), _nodes[best].object.get()))
+            {
+                best = child;
+            }
+        }
+        if(!_comparator(_nodes[best].object.get(), node.object.get()))
+        {
+            break;
+        }
+        place(_nodes[best], position);
+        position = best;
+    }
+    place(node, position);
+}
+
+// Floyd's bottom up construction, linear in the count of objects
+void HTHeap::heapify()
+{
+    if(_nodes.size() < 2)
+    {
+        return;
+    }
+    for(size_t position = (_nodes.size() - 2) / kArity + 1; position > 0; --position)
+    {
+        siftDown(position - 1);
+    }
+}
+
+void HTHeap::removeAtPosition(size_t position)
+{
+    Handle handle = _nodes[position].handle;
+    _positions[handle] = kNoPosition;
+    _freeHandles.push_back(handle);
+
+    size_t last = _nodes.size() - 1;
+    if(position == last)
+    {
+        _nodes.pop_back();
+        return;
+    }
+
+    // Fill the gap with the last node and move it whichever way it belongs
+    Handle moved = _nodes[last].handle;
+    _nodes[position] = std::move(_nodes[last]);
+    _nodes.pop_back();
+    _positions[moved] = position;
+    siftUp(position);
+    if(_positions[moved] == position)
+    {
+        siftDown(position);
+    }
+}
+
+NS_HT_END(Huta)
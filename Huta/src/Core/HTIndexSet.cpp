@@ -0,0 +1,823 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTIndexSet.h>
+
+#include <algorithm>
+#include <iterator>
+
+NS_HT_BEGIN(Huta)
+
+static const unsigned int kChunkBits = 16;
+static const size_t kChunkMask = (1 << kChunkBits) - 1;
+static const size_t kArrayMaxCount = 4096;
+static const size_t kBitmapWords = (1 << kChunkBits) / 64;
+
+static inline unsigned int popCount64(uint64_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(value);
+#else
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    return (((value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL) * 0x0101010101010101ULL) >> 56;
+#endif
+}
+
+static inline unsigned int trailingZeros64(uint64_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(value);
+#else
+    unsigned int count = 0;
+    while((value & 1) == 0)
+    {
+        value >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Set bits first to last of a bitmap, inclusive
+static void setBitRange(std::vector<uint64_t>& bits, uint32_t first, uint32_t last)
+{
+    size_t firstWord = first >> 6;
+    size_t lastWord = last >> 6;
+    uint64_t firstMask = ~0ULL << (first & 63);
+    uint64_t lastMask = ~0ULL >> (63 - (last & 63));
+    if(firstWord == lastWord)
+    {
+        bits[firstWord] |= firstMask & lastMask;
+        return;
+    }
+    bits[firstWord] |= firstMask;
+    for(size_t word = firstWord + 1; word < lastWord; ++word)
+    {
+        bits[word] = ~0ULL;
+    }
+    bits[lastWord] |= lastMask;
+}
+
+//--------------------------------------------------------------------
+//
+// Container
+//
+//--------------------------------------------------------------------
+
+HTIndexSet::Container::Container()
+: type(kArray)
+, cardinality(0)
+{
+
+}
+
+bool HTIndexSet::Container::contains(uint16_t value) const
+{
+    switch(type)
+    {
+        case kArray:
+            return std::binary_search(values.begin(), values.end(), value);
+        case kBitmap:
+            return (bits[value >> 6] >> (value & 63)) & 1;
+        case kRun:
+        {
+            // Last run starting at or before value
+            size_t low = 0;
+            size_t high = values.size() / 2;
+            while(low < high)
+            {
+                size_t middle = (low + high) / 2;
+                if(values[middle * 2] <= value)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            return low > 0 && value - values[(low - 1) * 2] <= values[(low - 1) * 2 + 1];
+        }
+    }
+    return false;
+}
+
+bool HTIndexSet::Container::add(uint16_t value)
+{
+    if(type == kArray)
+    {
+        auto it = std::lower_bound(values.begin(), values.end(), value);
+        if(it != values.end() && *it == value)
+        {
+            return false;
+        }
+        if(values.size() < kArrayMaxCount)
+        {
+            values.insert(it, value);
+            ++cardinality;
+            return true;
+        }
+        toBitmap();
+    }
+
+    if(type == kRun)
+    {
+        if(contains(value))
+        {
+            return false;
+        }
+
+        // Grow a neighbouring run or open a new one in place
+        size_t next = values.size();
+        for(size_t i = 0; i < values.size(); i += 2)
+        {
+            if(values[i] > value)
+            {
+                next = i;
+                break;
+            }
+        }
+        bool joinsPrevious = next > 0 && static_cast<uint32_t>(values[next - 2]) + values[next - 1] + 1 == value;
+        bool joinsNext = next < values.size() && static_cast<uint32_t>(value) + 1 == values[next];
+        if(joinsPrevious && joinsNext)
+        {
+            values[next - 1] = static_cast<uint16_t>(values[next - 1] + values[next + 1] + 2);
+            values.erase(values.begin() + next, values.begin() + next + 2);
+        }
+        else if(joinsPrevious)
+        {
+            ++values[next - 1];
+        }
+        else if(joinsNext)
+        {
+            values[next] = value;
+            ++values[next + 1];
+        }
+        else
+        {
+            uint16_t pair[2] = { value, 0 };
+            values.insert(values.begin() + next, pair, pair + 2);
+        }
+        ++cardinality;
+        optimizeRuns();
+        return true;
+    }
+
+    uint64_t& word = bits[value >> 6];
+    uint64_t mask = 1ULL << (value & 63);
+    if(word & mask)
+    {
+        return false;
+    }
+    word |= mask;
+    ++cardinality;
+    return true;
+}
+
+bool HTIndexSet::Container::remove(uint16_t value)
+{
+    if(!contains(value))
+    {
+        return false;
+    }
+
+    if(type == kArray)
+    {
+        values.erase(std::lower_bound(values.begin(), values.end(), value));
+        --cardinality;
+        return true;
+    }
+
+    if(type == kRun)
+    {
+        // Trim or split the run holding the value
+        size_t i = 0;
+        while(i + 2 < values.size() && values[i + 2] <= value)
+        {
+            i += 2;
+        }
+        uint32_t start = values[i];
+        uint32_t end = start + values[i + 1];
+        if(start == end)
+        {
+            values.erase(values.begin() + i, values.begin() + i + 2);
+        }
+        else if(value == start)
+        {
+            ++values[i];
+            --values[i + 1];
+        }
+        else if(value == end)
+        {
+            --values[i + 1];
+        }
+        else
+        {
+            values[i + 1] = static_cast<uint16_t>(value - 1 - start);
+            uint16_t pair[2] = { static_cast<uint16_t>(value + 1), static_cast<uint16_t>(end - value - 1) };
+            values.insert(values.begin() + i + 2, pair, pair + 2);
+        }
+        --cardinality;
+        optimizeRuns();
+        return true;
+    }
+
+    bits[value >> 6] &= ~(1ULL << (value & 63));
+    --cardinality;
+    if(cardinality <= kArrayMaxCount)
+    {
+        optimize();
+    }
+    return true;
+}
+
+void HTIndexSet::Container::addRange(uint32_t first, uint32_t last)
+{
+    if(first == 0 && last == kChunkMask)
+    {
+        type = kRun;
+        cardinality = kChunkMask + 1;
+        values.assign(1, 0);
+        values.push_back(static_cast<uint16_t>(kChunkMask));
+        std::vector<uint64_t>().swap(bits);
+        return;
+    }
+
+    toBitmap();
+    setBitRange(bits, first, last);
+    countBits();
+    optimize();
+}
+
+void HTIndexSet::Container::unite(const Container& other)
+{
+    if(type == kArray && other.type == kArray && cardinality + other.cardinality <= kArrayMaxCount)
+    {
+        std::vector<uint16_t> merged;
+        merged.reserve(cardinality + other.cardinality);
+        std::set_union(values.begin(), values.end(), other.values.begin(), other.values.end(),
+                       std::back_inserter(merged));
+        values.swap(merged);
+        cardinality = static_cast<uint32_t>(values.size());
+        return;
+    }
+
+    toBitmap();
+    switch(other.type)
+    {
+        case kArray:
+            for(auto value: other.values)
+            {
+                bits[value >> 6] |= 1ULL << (value & 63);
+            }
+            break;
+        case kBitmap:
+            for(size_t i = 0; i < kBitmapWords; ++i)
+            {
+                bits[i] |= other.bits[i];
+            }
+            break;
+        case kRun:
+            for(size_t i = 0; i < other.values.size(); i += 2)
+            {
+                setBitRange(bits, other.values[i], static_cast<uint32_t>(other.values[i]) + other.values[i + 1]);
+            }
+            break;
+    }
+    countBits();
+    optimize();
+}
+
+void HTIndexSet::Container::intersect(const Container& other)
+{
+    if(type == kArray || other.type == kArray)
+    {
+        const Container& array = (type == kArray) ? *this : other;
+        const Container& probe = (type == kArray) ? other : *this;
+        std::vector<uint16_t> kept;
+        kept.reserve(array.values.size());
+        for(auto value: array.values)
+        {
+            if(probe.contains(value))
+            {
+                kept.push_back(value);
+            }
+        }
+        type = kArray;
+        values.swap(kept);
+        std::vector<uint64_t>().swap(bits);
+        cardinality = static_cast<uint32_t>(values.size());
+        return;
+    }
+
+    Container otherBits;
+    const std::vector<uint64_t>* mask = &other.bits;
+    if(other.type != kBitmap)
+    {
+        otherBits = other;
+        otherBits.toBitmap();
+        mask = &otherBits.bits;
+    }
+
+    toBitmap();
+    for(size_t i = 0; i < kBitmapWords; ++i)
+    {
+        bits[i] &= (*mask)[i];
+    }
+    countBits();
+    optimize();
+}
+
+uint16_t HTIndexSet::Container::minimum() const
+{
+    if(type != kBitmap)
+    {
+        return values.front();
+    }
+    for(size_t i = 0; i < kBitmapWords; ++i)
+    {
+        if(bits[i])
+        {
+            return static_cast<uint16_t>(i * 64 + trailingZeros64(bits[i]));
+        }
+    }
+    return 0;
+}
+
+uint16_t HTIndexSet::Container::maximum() const
+{
+    if(type == kArray)
+    {
+        return values.back();
+    }
+    if(type == kRun)
+    {
+        return static_cast<uint16_t>(values[values.size() - 2] + values.back());
+    }
+    for(size_t i = kBitmapWords; i > 0; --i)
+    {
+        uint64_t word = bits[i - 1];
+        if(word)
+        {
+            unsigned int top = 63;
+            while(((word >> top) & 1) == 0)
+            {
+                --top;
+            }
+            return static_cast<uint16_t>((i - 1) * 64 + top);
+        }
+    }
+    return 0;
+}
+
+// Return false if the callback stopped the enumeration
+bool HTIndexSet::Container::enumerate(size_t base, const std::function<void(size_t index, bool* stop)>& callback) const
+{
+    bool stop = false;
+    switch(type)
+    {
+        case kArray:
+            for(auto value: values)
+            {
+                callback(base + value, &stop);
+                if(stop)
+                {
+                    return false;
+                }
+            }
+            break;
+        case kBitmap:
+            for(size_t i = 0; i < kBitmapWords; ++i)
+            {
+                for(uint64_t word = bits[i]; word; word &= word - 1)
+                {
+                    callback(base + i * 64 + trailingZeros64(word), &stop);
+                    if(stop)
+                    {
+                        return false;
+                    }
+                }
+            }
+            break;
+        case kRun:
+            for(size_t i = 0; i < values.size(); i += 2)
+            {
+                size_t first = base + values[i];
+                size_t last = first + values[i + 1];
+                for(size_t index = first; index <= last; ++index)
+                {
+                    callback(index, &stop);
+                    if(stop)
+                    {
+                        return false;
+                    }
+                }
+            }
+            break;
+    }
+    return true;
+}
+
+size_t HTIndexSet::Container::byteSize() const
+{
+    return values.capacity() * sizeof(uint16_t) + bits.capacity() * sizeof(uint64_t);
+}
+
+void HTIndexSet::Container::toBitmap()
+{
+    if(type == kBitmap)
+    {
+        return;
+    }
+
+    std::vector<uint64_t> bitmap(kBitmapWords, 0);
+    if(type == kArray)
+    {
+        for(auto value: values)
+        {
+            bitmap[value >> 6] |= 1ULL << (value & 63);
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < values.size(); i += 2)
+        {
+            setBitRange(bitmap, values[i], static_cast<uint32_t>(values[i]) + values[i + 1]);
+        }
+    }
+    bits.swap(bitmap);
+    std::vector<uint16_t>().swap(values);
+    type = kBitmap;
+}
+
+// Switch to the smallest of the three representations
+void HTIndexSet::Container::optimize()
+{
+    toBitmap();
+
+    size_t runs = 0;
+    uint64_t carry = 0;
+    for(size_t i = 0; i < kBitmapWords; ++i)
+    {
+        uint64_t word = bits[i];
+        runs += popCount64(word & ~((word << 1) | carry));
+        carry = word >> 63;
+    }
+
+    size_t runBytes = runs * 2 * sizeof(uint16_t);
+    size_t arrayBytes = cardinality <= kArrayMaxCount ? cardinality * sizeof(uint16_t) : SIZE_MAX;
+    size_t bitmapBytes = kBitmapWords * sizeof(uint64_t);
+
+    if(runBytes < arrayBytes && runBytes < bitmapBytes)
+    {
+        std::vector<uint16_t> pairs;
+        pairs.reserve(runs * 2);
+        bool inRun = false;
+        uint32_t start = 0;
+        for(size_t i = 0; i < kBitmapWords; ++i)
+        {
+            uint64_t word = bits[i];
+            // Words that neither start nor end a run need no bit walk
+            if((!inRun && word == 0) || (inRun && word == ~0ULL))
+            {
+                continue;
+            }
+            for(uint32_t bit = 0; bit < 64; ++bit)
+            {
+                bool set = (word >> bit) & 1;
+                uint32_t value = static_cast<uint32_t>(i * 64) + bit;
+                if(set && !inRun)
+                {
+                    start = value;
+                    inRun = true;
+                }
+                else if(!set && inRun)
+                {
+                    pairs.push_back(static_cast<uint16_t>(start));
+                    pairs.push_back(static_cast<uint16_t>(value - 1 - start));
+                    inRun = false;
+                }
+            }
+        }
+        if(inRun)
+        {
+            pairs.push_back(static_cast<uint16_t>(start));
+            pairs.push_back(static_cast<uint16_t>(kChunkMask - start));
+        }
+        values.swap(pairs);
+        std::vector<uint64_t>().swap(bits);
+        type = kRun;
+    }
+    else if(arrayBytes <= bitmapBytes)
+    {
+        std::vector<uint16_t> array;
+        array.reserve(cardinality);
+        for(size_t i = 0; i < kBitmapWords; ++i)
+        {
+            for(uint64_t word = bits[i]; word; word &= word - 1)
+            {
+                array.push_back(static_cast<uint16_t>(i * 64 + trailingZeros64(word)));
+            }
+        }
+        values.swap(array);
+        std::vector<uint64_t>().swap(bits);
+        type = kArray;
+    }
+}
+
+// Leave the run representation once it stops being the smallest
+void HTIndexSet::Container::optimizeRuns()
+{
+    size_t runBytes = values.size() * sizeof(uint16_t);
+    size_t arrayBytes = cardinality <= kArrayMaxCount ? cardinality * sizeof(uint16_t) : SIZE_MAX;
+    size_t bitmapBytes = kBitmapWords * sizeof(uint64_t);
+    if(values.empty() || runBytes >= arrayBytes || runBytes >= bitmapBytes)
+    {
+        optimize();
+    }
+}
+
+void HTIndexSet::Container::countBits()
+{
+    uint32_t count = 0;
+    for(auto word: bits)
+    {
+        count += popCount64(word);
+    }
+    cardinality = count;
+}
+
+//--------------------------------------------------------------------
+//
+// HTIndexSet
+//
+//--------------------------------------------------------------------
+
+HTIndexSet* HTIndexSet::create()
+{
+    HTIndexSet* ret = new HTIndexSet();
+    if(ret)
+    {
+        ret->autorelease();
+    }
+    return ret;
+}
+
+HTIndexSet* HTIndexSet::createWithIndex(size_t index)
+{
+    HTIndexSet* ret = HTIndexSet::create();
+    if(ret)
+    {
+        ret->addIndex(index);
+    }
+    return ret;
+}
+
+HTIndexSet* HTIndexSet::createWithIndexesInRange(size_t location, size_t length)
+{
+    HTIndexSet* ret = HTIndexSet::create();
+    if(ret)
+    {
+        ret->addIndexesInRange(location, length);
+    }
+    return ret;
+}
+
+HTIndexSet::HTIndexSet()
+{
+
+}
+
+HTIndexSet::HTIndexSet(const HTIndexSet& other)
+: _keys(other._keys)
+, _containers(other._containers)
+{
+
+}
+
+HTIndexSet::~HTIndexSet()
+{
+
+}
+
+size_t HTIndexSet::count() const
+{
+    size_t count = 0;
+    for(auto& container: _containers)
+    {
+        count += container.cardinality;
+    }
+    return count;
+}
+
+bool HTIndexSet::containsIndex(size_t index) const
+{
+    size_t key = index >> kChunkBits;
+    auto it = std::lower_bound(_keys.begin(), _keys.end(), key);
+    if(it == _keys.end() || *it != key)
+    {
+        return false;
+    }
+    return _containers[it - _keys.begin()].contains(static_cast<uint16_t>(index & kChunkMask));
+}
+
+ssize_t HTIndexSet::firstIndex() const
+{
+    if(_keys.empty())
+    {
+        return -1;
+    }
+    return static_cast<ssize_t>((_keys.front() << kChunkBits) + _containers.front().minimum());
+}
+
+ssize_t HTIndexSet::lastIndex() const
+{
+    if(_keys.empty())
+    {
+        return -1;
+    }
+    return static_cast<ssize_t>((_keys.back() << kChunkBits) + _containers.back().maximum());
+}
+
+HTIndexSet::Container& HTIndexSet::containerForKey(size_t key)
+{
+    // Ascending insertion only ever touches the last container
+    if(!_keys.empty() && _keys.back() == key)
+    {
+        return _containers.back();
+    }
+
+    auto it = std::lower_bound(_keys.begin(), _keys.end(), key);
+    size_t position = it - _keys.begin();
+    if(it == _keys.end() || *it != key)
+    {
+        _keys.insert(it, key);
+        _containers.insert(_containers.begin() + position, Container());
+    }
+    return _containers[position];
+}
+
+void HTIndexSet::addIndex(size_t index)
+{
+    containerForKey(index >> kChunkBits).add(static_cast<uint16_t>(index & kChunkMask));
+}
+
+void HTIndexSet::addIndexesInRange(size_t location, size_t length)
+{
+    if(length == 0)
+    {
+        return;
+    }
+
+    size_t last = location + length - 1;
+    for(size_t key = location >> kChunkBits; key <= (last >> kChunkBits); ++key)
+    {
+        size_t chunkFirst = key << kChunkBits;
+        uint32_t first = location > chunkFirst ? static_cast<uint32_t>(location - chunkFirst) : 0;
+        uint32_t lastInChunk = last < chunkFirst + kChunkMask ? static_cast<uint32_t>(last - chunkFirst) : kChunkMask;
+        containerForKey(key).addRange(first, lastInChunk);
+    }
+}
+
+void HTIndexSet::removeIndex(size_t index)
+{
+    size_t key = index >> kChunkBits;
+    auto it = std::lower_bound(_keys.begin(), _keys.end(), key);
+    if(it == _keys.end() || *it != key)
+    {
+        return;
+    }
+
+    size_t position = it - _keys.begin();
+    Container& container = _containers[position];
+    container.remove(static_cast<uint16_t>(index & kChunkMask));
+    if(container.cardinality == 0)
+    {
+        _keys.erase(it);
+        _containers.erase(_containers.begin() + position);
+    }
+}
+
+void HTIndexSet::removeAllIndexes()
+{
+    _keys.clear();
+    _containers.clear();
+}
+
+void HTIndexSet::unionIndexSet(HTIndexSet* other)
+{
+    if(other == this)
+    {
+        return;
+    }
+
+    std::vector<size_t> keys;
+    std::vector<Container> containers;
+    keys.reserve(_keys.size() + other->_keys.size());
+    containers.reserve(_keys.size() + other->_keys.size());
+
+    size_t i = 0;
+    size_t j = 0;
+    while(i < _keys.size() || j < other->_keys.size())
+    {
+        if(j == other->_keys.size() || (i < _keys.size() && _keys[i] < other->_keys[j]))
+        {
+            keys.push_back(_keys[i]);
+            containers.push_back(std::move(_containers[i++]));
+        }
+        else if(i == _keys.size() || other->_keys[j] < _keys[i])
+        {
+            keys.push_back(other->_keys[j]);
+            containers.push_back(other->_containers[j++]);
+        }
+        else
+        {
+            keys.push_back(_keys[i]);
+            containers.push_back(std::move(_containers[i++]));
+            containers.back().unite(other->_containers[j++]);
+        }
+    }
+    _keys.swap(keys);
+    _containers.swap(containers);
+}
+
+void HTIndexSet::intersectIndexSet(HTIndexSet* other)
+{
+    if(other == this)
+    {
+        return;
+    }
+
+    std::vector<size_t> keys;
+    std::vector<Container> containers;
+    size_t i = 0;
+    size_t j = 0;
+    while(i < _keys.size() && j < other->_keys.size())
+    {
+        if(_keys[i] < other->_keys[j])
+        {
+            ++i;
+        }
+        else if(other->_keys[j] < _keys[i])
+        {
+            ++j;
+        }
+        else
+        {
+            Container& container = _containers[i];
+            container.intersect(other->_containers[j]);
+            if(container.cardinality > 0)
+            {
+                keys.push_back(_keys[i]);
+                containers.push_back(std::move(container));
+            }
+            ++i;
+            ++j;
+        }
+    }
+    _keys.swap(keys);
+    _containers.swap(containers);
+}
+
+void HTIndexSet::enumerateIndexes(const std::function<void(size_t index, bool* stop)>& callback) const
+{
+    for(size_t i = 0; i < _keys.size(); ++i)
+    {
+        if(!_containers[i].enumerate(_keys[i] << kChunkBits, callback))
+        {
+            return;
+        }
+    }
+}
+
+size_t HTIndexSet::getByteSize() const
+{
+    size_t size = _keys.capacity() * sizeof(size_t) + _containers.capacity() * sizeof(Container);
+    for(auto& container: _containers)
+    {
+        size += container.byteSize();
+    }
+    return size;
+}
+
+NS_HT_END(Huta)
@@ -0,0 +1,304 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTNumber.h>
+#include <Core/HTOutputSink.h>
+#include <Core/HTHash.h>
+#include <Core/HTString.h>
+
+#include <cmath>
+#include <cstring>
+
+NS_HT_BEGIN(Huta)
+
+static const int64_t kCachedMinimum = -128;
+static const int64_t kCachedMaximum = 1023;
+static const size_t kCachedCount = kCachedMaximum - kCachedMinimum + 1;
+
+// Shared immortal instances, built once on first use
+struct HTNumberCache
+{
+    HTNumberCache()
+    {
+        for(size_t i = 0; i < kCachedCount; ++i)
+        {
+            int64_t value = kCachedMinimum + static_cast<int64_t>(i);
+            ints[i] = make(HTNumber::kInt64, value, 0.0);
+            doubles[i] = make(HTNumber::kDouble, 0, static_cast<double>(value));
+        }
+        bools[0] = make(HTNumber::kBool, 0, 0.0);
+        bools[1] = make(HTNumber::kBool, 1, 0.0);
+    }
+
+    static HTNumber* make(HTNumber::Type type, int64_t intValue, double doubleValue)
+    {
+        HTNumber* number = new HTNumber();
+        number->_type = type;
+        if(type == HTNumber::kDouble)
+        {
+            number->_double = doubleValue;
+        }
+        else
+        {
+            number->_int = intValue;
+        }
+        number->makeImmortal();
+        return number;
+    }
+
+    static const HTNumberCache& getInstance()
+    {
+        static HTNumberCache cache;
+        return cache;
+    }
+
+    HTNumber* ints[kCachedCount];
+    HTNumber* doubles[kCachedCount];
+    HTNumber* bools[2];
+};
+
+HTNumber* HTNumber::createWithInt(int64_t value)
+{
+    if(value >= kCachedMinimum && value <= kCachedMaximum)
+    {
+        return HTNumberCache::getInstance().ints[value - kCachedMinimum];
+    }
+
+    HTNumber* number = new HTNumber();
+    number->_type = kInt64;
+    number->_int = value;
+    number->autorelease();
+    return number;
+}
+
+HTNumber* HTNumber::createWithDouble(double value)
+{
+    // Negative zero keeps its sign, so it is not shared with zero
+    if(value >= kCachedMinimum && value <= kCachedMaximum && value == std::floor(value) && !std::signbit(value))
+    {
+        return HTNumberCache::getInstance().doubles[static_cast<int64_t>(value) - kCachedMinimum];
+    }
+
+    HTNumber* number = new HTNumber();
+    number->_type = kDouble;
+    number->_double = value;
+    number->autorelease();
+    return number;
+}
+
+HTNumber* HTNumber::createWithBool(bool value)
+{
+    return HTNumberCache::getInstance().bools[value ? 1 : 0];
+}
+
+HTNumber::HTNumber()
+: _type(kInt64)
+, _int(0)
+{
+
+}
+
+HTNumber::~HTNumber()
+{
+
+}
+
+int64_t HTNumber::int64Value() const
+{
+    if(_type == kDouble)
+    {
+        return int64FromDouble(_double);
+    }
+    return _int;
+}
+
+double HTNumber::doubleValue() const
+{
+    if(_type == kDouble)
+    {
+        return _double;
+    }
+    return static_cast<double>(_int);
+}
+
+bool HTNumber::boolValue() const
+{
+    if(_type == kDouble)
+    {
+        return _double != 0.0;
+    }
+    return _int != 0;
+}
+
+// Whether truncating value toward zero gives an int64. 2^63 is exact in double, anything at or
+// above it does not fit, and NaN compares false
+static bool isInInt64Range(double value)
+{
+    return value >= -9223372036854775808.0 && value < 9223372036854775808.0;
+}
+
+bool HTNumber::exactInt64(int64_t& value) const
+{
+    if(_type != kDouble)
+    {
+        value = _int;
+        return true;
+    }
+
+    if(isInInt64Range(_double) && _double == std::floor(_double))
+    {
+        value = static_cast<int64_t>(_double);
+        return true;
+    }
+    return false;
+}
+
+int64_t HTNumber::int64FromDouble(double value)
+{
+    if(isInInt64Range(value))
+    {
+        return static_cast<int64_t>(value);
+    }
+    if(std::isnan(value))
+    {
+        return 0;
+    }
+    return value > 0 ? INT64_MAX : INT64_MIN;
+}
+
+// Order an integer against a double that is not an integer in the int64 range, without
+// rounding the integer to a double
+static int compareExactly(int64_t value, double number)
+{
+    if(number >= 9223372036854775808.0)
+    {
+        return -1;
+    }
+    if(number < -9223372036854775808.0)
+    {
+        return 1;
+    }
+    return value <= static_cast<int64_t>(std::floor(number)) ? -1 : 1;
+}
+
+int HTNumber::compare(const HTNumber* other) const
+{
+    int64_t value = 0;
+    int64_t otherValue = 0;
+    bool exact = exactInt64(value);
+    bool otherExact = other->exactInt64(otherValue);
+    if(exact && otherExact)
+    {
+        return value < otherValue ? -1 : (value > otherValue ? 1 : 0);
+    }
+    if(exact && !std::isnan(other->_double))
+    {
+        return compareExactly(value, other->_double);
+    }
+    if(otherExact && !std::isnan(_double))
+    {
+        return -compareExactly(otherValue, _double);
+    }
+
+    // NaN is ordered before every other number so that sorting stays consistent
+    double number = doubleValue();
+    double otherNumber = other->doubleValue();
+    bool isNaN = std::isnan(number);
+    bool otherIsNaN = std::isnan(otherNumber);
+    if(isNaN || otherIsNaN)
+    {
+        return isNaN == otherIsNaN ? 0 : (isNaN ? -1 : 1);
+    }
+    return number < otherNumber ? -1 : (number > otherNumber ? 1 : 0);
+}
+
+bool HTNumber::isEqual(const HTObject* other)
+{
+    if(other == this)
+    {
+        return true;
+    }
+
+    const HTNumber* number = dynamic_cast<const HTNumber*>(other);
+    if(number == nullptr)
+    {
+        return false;
+    }
+
+    // A number that is an exact int64 never equals one that is not, the rounding of a
+    // double comparison would make large integers equal to doubles that hash differently
+    int64_t value = 0;
+    int64_t otherValue = 0;
+    bool exact = exactInt64(value);
+    bool otherExact = number->exactInt64(otherValue);
+    if(exact || otherExact)
+    {
+        return exact && otherExact && value == otherValue;
+    }
+    return _double == number->_double;
+}
+
+size_t HTNumber::hash() const
+{
+    // Integral doubles hash like the integer so that equal numbers hash the same
+    int64_t value = 0;
+    if(exactInt64(value))
+    {
+        return static_cast<size_t>(HTHash::mix(static_cast<uint64_t>(value)));
+    }
+
+    uint64_t bits = 0;
+    memcpy(&bits, &_double, sizeof(bits));
+    return static_cast<size_t>(HTHash::mix(bits));
+}
+
+HTString* HTNumber::toString() const
+{
+    switch(_type)
+    {
+        case kBool:
+            return HTString::format("{}", _int != 0);
+        case kInt64:
+            return HTString::format("{}", _int);
+        case kDouble:
+            break;
+    }
+    return HTString::format("{}", _double);
+}
+
+void HTNumber::describeSelfTo(HTOutputSink& sink) const
+{
+    switch(_type)
+    {
+        case kBool:
+            sink.appendValue(_int != 0);
+            return;
+        case kInt64:
+            sink.appendValue(_int);
+            return;
+        case kDouble:
+            break;
+    }
+    sink.appendValue(_double);
+}
+
+NS_HT_END(Huta)
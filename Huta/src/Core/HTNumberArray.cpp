@@ -0,0 +1,704 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTNumberArray.h>
+#include <Core/HTNumber.h>
+#include <Core/HTArray.h>
+#include <Core/HTString.h>
+#include <Core/HTStringArray.h>
+#include <Core/HTStringSlice.h>
+#include <Core/HTNumberParser.h>
+#include <Core/HTException.h>
+#include <Core/HTOutputSink.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+NS_HT_BEGIN(Huta)
+
+// Count the values for which test is true, the count is added without a branch
+template <typename T, typename Test>
+static size_t countValues(const std::vector<T>& values, Test test)
+{
+    size_t count = 0;
+    for(auto value: values)
+    {
+        count += test(value) ? 1 : 0;
+    }
+    return count;
+}
+
+template <typename T>
+static size_t countCompared(const std::vector<T>& values, HTNumberArray::Comparison comparison, T operand)
+{
+    switch(comparison)
+    {
+        case HTNumberArray::kLess:
+            return countValues(values, [operand](T value) { return value < operand; });
+        case HTNumberArray::kLessOrEqual:
+            return countValues(values, [operand](T value) { return value <= operand; });
+        case HTNumberArray::kEqual:
+            return countValues(values, [operand](T value) { return value == operand; });
+        case HTNumberArray::kNotEqual:
+            return countValues(values, [operand](T value) { return value != operand; });
+        case HTNumberArray::kGreaterOrEqual:
+            return countValues(values, [operand](T value) { return value >= operand; });
+        case HTNumberArray::kGreater:
+            return countValues(values, [operand](T value) { return value > operand; });
+    }
+    return 0;
+}
+
+static double sumDoubles(const double* values, size_t count)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256d first = _mm256_setzero_pd();
+    __m256d second = _mm256_setzero_pd();
+    for(; i + 8 <= count; i += 8)
+    {
+        first = _mm256_add_pd(first, _mm256_loadu_pd(values + i));
+        second = _mm256_add_pd(second, _mm256_loadu_pd(values + i + 4));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(first, second));
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    double lanes[4] = { 0.0, 0.0, 0.0, 0.0 };
+    for(; i + 4 <= count; i += 4)
+    {
+        lanes[0] += values[i];
+        lanes[1] += values[i + 1];
+        lanes[2] += values[i + 2];
+        lanes[3] += values[i + 3];
+    }
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for(; i < count; ++i)
+    {
+        total += values[i];
+    }
+    return total;
+}
+
+static double dotDoubles(const double* values, const double* others, size_t count)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256d first = _mm256_setzero_pd();
+    __m256d second = _mm256_setzero_pd();
+    for(; i + 8 <= count; i += 8)
+    {
+        first = _mm256_add_pd(first, _mm256_mul_pd(_mm256_loadu_pd(values + i), _mm256_loadu_pd(others + i)));
+        second = _mm256_add_pd(second, _mm256_mul_pd(_mm256_loadu_pd(values + i + 4), _mm256_loadu_pd(others + i + 4)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(first, second));
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    double lanes[4] = { 0.0, 0.0, 0.0, 0.0 };
+    for(; i + 4 <= count; i += 4)
+    {
+        lanes[0] += values[i] * others[i];
+        lanes[1] += values[i + 1] * others[i + 1];
+        lanes[2] += values[i + 2] * others[i + 2];
+        lanes[3] += values[i + 3] * others[i + 3];
+    }
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for(; i < count; ++i)
+    {
+        total += values[i] * others[i];
+    }
+    return total;
+}
+
+// Smallest value, or largest if largest is true. NaN values never win a comparison so
+// they are skipped, the result is NaN only if every value is NaN
+static double extremeDouble(const double* values, size_t count, bool largest)
+{
+    const double start = largest ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+    size_t i = 0;
+#if defined(__AVX2__)
+    // min and max return the second operand when the first is NaN
+    __m256d extreme = _mm256_set1_pd(start);
+    for(; i + 4 <= count; i += 4)
+    {
+        __m256d block = _mm256_loadu_pd(values + i);
+        extreme = largest ? _mm256_max_pd(block, extreme) : _mm256_min_pd(block, extreme);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, extreme);
+#else
+    double lanes[4] = { start, start, start, start };
+    for(; i + 4 <= count; i += 4)
+    {
+        for(size_t lane = 0; lane < 4; ++lane)
+        {
+            double value = values[i + lane];
+            lanes[lane] = (largest ? value > lanes[lane] : value < lanes[lane]) ? value : lanes[lane];
+        }
+    }
+#endif
+    double result = start;
+    for(size_t lane = 0; lane < 4; ++lane)
+    {
+        result = (largest ? lanes[lane] > result : lanes[lane] < result) ? lanes[lane] : result;
+    }
+    for(; i < count; ++i)
+    {
+        result = (largest ? values[i] > result : values[i] < result) ? values[i] : result;
+    }
+
+    if(result == start && std::none_of(values, values + count, [](double value) { return !std::isnan(value); }))
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return result;
+}
+
+static int64_t extremeInt64(const int64_t* values, size_t count, bool largest)
+{
+    int64_t lanes[4] = { values[0], values[0], values[0], values[0] };
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        for(size_t lane = 0; lane < 4; ++lane)
+        {
+            int64_t value = values[i + lane];
+            lanes[lane] = (largest ? value > lanes[lane] : value < lanes[lane]) ? value : lanes[lane];
+        }
+    }
+    int64_t result = lanes[0];
+    for(size_t lane = 1; lane < 4; ++lane)
+    {
+        result = (largest ? lanes[lane] > result : lanes[lane] < result) ? lanes[lane] : result;
+    }
+    for(; i < count; ++i)
+    {
+        result = (largest ? values[i] > result : values[i] < result) ? values[i] : result;
+    }
+    return result;
+}
+
+HTNumberArray* HTNumberArray::createWithType(Type type)
+{
+    return createWithCapacity(type, 0);
+}
+
+HTNumberArray* HTNumberArray::createWithCapacity(Type type, size_t capacity)
+{
+    HTNumberArray* object = new HTNumberArray();
+    if(object && object->initWithCapacity(type, capacity))
+    {
+        object->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(object);
+    }
+    return object;
+}
+
+HTNumberArray* HTNumberArray::createWithInt64Values(const int64_t* values, size_t count)
+{
+    HTNumberArray* array = createWithType(kInt64);
+    if(array)
+    {
+        array->_ints.assign(values, values + count);
+    }
+    return array;
+}
+
+HTNumberArray* HTNumberArray::createWithDoubleValues(const double* values, size_t count)
+{
+    HTNumberArray* array = createWithType(kDouble);
+    if(array)
+    {
+        array->_doubles.assign(values, values + count);
+    }
+    return array;
+}
+
+HTNumberArray* HTNumberArray::createWithArray(HTArray* array, Type type)
+{
+    HTNumberArray* numbers = createWithCapacity(type, array->count());
+    if(numbers == nullptr)
+    {
+        return nullptr;
+    }
+
+    for(const auto& object: *array)
+    {
+        HTNumber* number = dynamic_cast<HTNumber*>(object.get());
+        if(number == nullptr)
+        {
+            throw HTException("Array element is not a number");
+        }
+        if(type == kInt64)
+        {
+            numbers->_ints.push_back(number->int64Value());
+        }
+        else
+        {
+            numbers->_doubles.push_back(number->doubleValue());
+        }
+    }
+    return numbers;
+}
+
+HTNumberArray* HTNumberArray::createByParsingStrings(HTStringArray* strings, Type type, size_t* errorIndex)
+{
+    HTNumberArray* numbers = createWithCapacity(type, strings->count());
+    if(numbers == nullptr)
+    {
+        return nullptr;
+    }
+
+    for(size_t i = 0; i < strings->count(); ++i)
+    {
+        if(!numbers->addParsedValue(strings->viewAtIndex(i)))
+        {
+            if(errorIndex != nullptr)
+            {
+                *errorIndex = i;
+            }
+            return nullptr;
+        }
+    }
+    return numbers;
+}
+
+HTNumberArray* HTNumberArray::createByParsingArray(HTArray* array, Type type, size_t* errorIndex)
+{
+    HTNumberArray* numbers = createWithCapacity(type, array->count());
+    if(numbers == nullptr)
+    {
+        return nullptr;
+    }
+
+    size_t index = 0;
+    for(const auto& object: *array)
+    {
+        bool parsed = false;
+        HTString* string = dynamic_cast<HTString*>(object.get());
+        if(string != nullptr)
+        {
+            parsed = numbers->addParsedValue(HTStringView(string->getCString(), string->length()));
+        }
+        else
+        {
+            HTStringSlice* slice = dynamic_cast<HTStringSlice*>(object.get());
+            parsed = slice != nullptr && numbers->addParsedValue(slice->getView());
+        }
+
+        if(!parsed)
+        {
+            if(errorIndex != nullptr)
+            {
+                *errorIndex = index;
+            }
+            return nullptr;
+        }
+        ++index;
+    }
+    return numbers;
+}
+
+HTNumberArray::HTNumberArray()
+: _type(kInt64)
+{
+
+}
+
+HTNumberArray::~HTNumberArray()
+{
+
+}
+
+bool HTNumberArray::addParsedValue(const HTStringView& view)
+{
+    if(_type == kInt64)
+    {
+        int64_t value = 0;
+        if(HTNumberParser::parseAll(view, value) != kHTParseSuccess)
+        {
+            return false;
+        }
+        _ints.push_back(value);
+    }
+    else
+    {
+        double value = 0;
+        if(HTNumberParser::parseAll(view, value) != kHTParseSuccess)
+        {
+            return false;
+        }
+        _doubles.push_back(value);
+    }
+    return true;
+}
+
+bool HTNumberArray::initWithCapacity(Type type, size_t capacity)
+{
+    _type = type;
+    _ints.clear();
+    _doubles.clear();
+    if(type == kInt64)
+    {
+        _ints.reserve(capacity);
+    }
+    else
+    {
+        _doubles.reserve(capacity);
+    }
+    return true;
+}
+
+const int64_t* HTNumberArray::getInt64Values() const
+{
+    return _type == kInt64 ? _ints.data() : nullptr;
+}
+
+const double* HTNumberArray::getDoubleValues() const
+{
+    return _type == kDouble ? _doubles.data() : nullptr;
+}
+
+int64_t HTNumberArray::int64ValueAtIndex(size_t index) const
+{
+    return _type == kInt64 ? _ints[index] : HTNumber::int64FromDouble(_doubles[index]);
+}
+
+double HTNumberArray::doubleValueAtIndex(size_t index) const
+{
+    return _type == kDouble ? _doubles[index] : static_cast<double>(_ints[index]);
+}
+
+void HTNumberArray::addInt64Value(int64_t value)
+{
+    if(_type == kInt64)
+    {
+        _ints.push_back(value);
+    }
+    else
+    {
+        _doubles.push_back(static_cast<double>(value));
+    }
+}
+
+void HTNumberArray::addDoubleValue(double value)
+{
+    if(_type == kDouble)
+    {
+        _doubles.push_back(value);
+    }
+    else
+    {
+        _ints.push_back(HTNumber::int64FromDouble(value));
+    }
+}
+
+void HTNumberArray::addValuesFromArray(HTNumberArray* other)
+{
+    if(_type == other->_type)
+    {
+        if(_type == kInt64)
+        {
+            _ints.insert(_ints.end(), other->_ints.begin(), other->_ints.end());
+        }
+        else
+        {
+            _doubles.insert(_doubles.end(), other->_doubles.begin(), other->_doubles.end());
+        }
+        return;
+    }
+
+    if(_type == kInt64)
+    {
+        for(auto value: other->_doubles)
+        {
+            _ints.push_back(HTNumber::int64FromDouble(value));
+        }
+    }
+    else
+    {
+        for(auto value: other->_ints)
+        {
+            _doubles.push_back(static_cast<double>(value));
+        }
+    }
+}
+
+void HTNumberArray::setDoubleValue(double value, size_t index)
+{
+    if(_type == kDouble)
+    {
+        _doubles[index] = value;
+    }
+    else
+    {
+        _ints[index] = HTNumber::int64FromDouble(value);
+    }
+}
+
+void HTNumberArray::setInt64Value(int64_t value, size_t index)
+{
+    if(_type == kInt64)
+    {
+        _ints[index] = value;
+    }
+    else
+    {
+        _doubles[index] = static_cast<double>(value);
+    }
+}
+
+void HTNumberArray::removeAllValues()
+{
+    _ints.clear();
+    _doubles.clear();
+}
+
+int64_t HTNumberArray::int64Sum() const
+{
+    if(_type == kDouble)
+    {
+        return HTNumber::int64FromDouble(sum());
+    }
+
+    // Unsigned lanes wrap around instead of overflowing
+    uint64_t lanes[4] = { 0, 0, 0, 0 };
+    size_t count = _ints.size();
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        lanes[0] += static_cast<uint64_t>(_ints[i]);
+        lanes[1] += static_cast<uint64_t>(_ints[i + 1]);
+        lanes[2] += static_cast<uint64_t>(_ints[i + 2]);
+        lanes[3] += static_cast<uint64_t>(_ints[i + 3]);
+    }
+    uint64_t total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for(; i < count; ++i)
+    {
+        total += static_cast<uint64_t>(_ints[i]);
+    }
+    return static_cast<int64_t>(total);
+}
+
+double HTNumberArray::sum() const
+{
+    if(_type == kDouble)
+    {
+        return sumDoubles(_doubles.data(), _doubles.size());
+    }
+
+    double lanes[4] = { 0.0, 0.0, 0.0, 0.0 };
+    size_t count = _ints.size();
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        lanes[0] += static_cast<double>(_ints[i]);
+        lanes[1] += static_cast<double>(_ints[i + 1]);
+        lanes[2] += static_cast<double>(_ints[i + 2]);
+        lanes[3] += static_cast<double>(_ints[i + 3]);
+    }
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for(; i < count; ++i)
+    {
+        total += static_cast<double>(_ints[i]);
+    }
+    return total;
+}
+
+double HTNumberArray::min() const
+{
+    if(count() == 0)
+    {
+        throw HTException("Array is empty");
+    }
+    if(_type == kInt64)
+    {
+        return static_cast<double>(extremeInt64(_ints.data(), _ints.size(), false));
+    }
+    return extremeDouble(_doubles.data(), _doubles.size(), false);
+}
+
+double HTNumberArray::max() const
+{
+    if(count() == 0)
+    {
+        throw HTException("Array is empty");
+    }
+    if(_type == kInt64)
+    {
+        return static_cast<double>(extremeInt64(_ints.data(), _ints.size(), true));
+    }
+    return extremeDouble(_doubles.data(), _doubles.size(), true);
+}
+
+int64_t HTNumberArray::int64Min() const
+{
+    if(_type == kDouble)
+    {
+        return HTNumber::int64FromDouble(min());
+    }
+    if(_ints.empty())
+    {
+        throw HTException("Array is empty");
+    }
+    return extremeInt64(_ints.data(), _ints.size(), false);
+}
+
+int64_t HTNumberArray::int64Max() const
+{
+    if(_type == kDouble)
+    {
+        return HTNumber::int64FromDouble(max());
+    }
+    if(_ints.empty())
+    {
+        throw HTException("Array is empty");
+    }
+    return extremeInt64(_ints.data(), _ints.size(), true);
+}
+
+double HTNumberArray::mean() const
+{
+    if(count() == 0)
+    {
+        throw HTException("Array is empty");
+    }
+    return sum() / static_cast<double>(count());
+}
+
+double HTNumberArray::dot(HTNumberArray* other) const
+{
+    size_t size = count();
+    if(other->count() != size)
+    {
+        throw HTException("Array counts differ");
+    }
+
+    if(_type == kDouble && other->_type == kDouble)
+    {
+        return dotDoubles(_doubles.data(), other->_doubles.data(), size);
+    }
+
+    double total = 0.0;
+    for(size_t i = 0; i < size; ++i)
+    {
+        total += doubleValueAtIndex(i) * other->doubleValueAtIndex(i);
+    }
+    return total;
+}
+
+size_t HTNumberArray::countIf(Comparison comparison, double value) const
+{
+    if(_type == kDouble)
+    {
+        return countCompared(_doubles, comparison, value);
+    }
+
+    // Integral operands compare exactly, others go through double
+    if(value >= -9223372036854775808.0 && value < 9223372036854775808.0 && value == std::floor(value))
+    {
+        return countCompared(_ints, comparison, HTNumber::int64FromDouble(value));
+    }
+
+    size_t count = 0;
+    for(auto number: _ints)
+    {
+        double converted = static_cast<double>(number);
+        switch(comparison)
+        {
+            case kLess: count += converted < value ? 1 : 0; break;
+            case kLessOrEqual: count += converted <= value ? 1 : 0; break;
+            case kEqual: count += converted == value ? 1 : 0; break;
+            case kNotEqual: count += converted != value ? 1 : 0; break;
+            case kGreaterOrEqual: count += converted >= value ? 1 : 0; break;
+            case kGreater: count += converted > value ? 1 : 0; break;
+        }
+    }
+    return count;
+}
+
+void HTNumberArray::sort()
+{
+    if(_type == kInt64)
+    {
+        std::sort(_ints.begin(), _ints.end());
+        return;
+    }
+
+    // NaN breaks the ordering std::sort relies on, move it out of the way first
+    auto end = std::partition(_doubles.begin(), _doubles.end(), [](double value) { return !std::isnan(value); });
+    std::sort(_doubles.begin(), end);
+}
+
+HTArray* HTNumberArray::toArray() const
+{
+    HTArray* array = HTArray::createWithCapacity(count());
+    if(_type == kInt64)
+    {
+        for(auto value: _ints)
+        {
+            array->addObject(HTNumber::createWithInt(value));
+        }
+    }
+    else
+    {
+        for(auto value: _doubles)
+        {
+            array->addObject(HTNumber::createWithDouble(value));
+        }
+    }
+    return array;
+}
+
+void HTNumberArray::describeSelfTo(HTOutputSink& sink) const
+{
+    sink.appendCharacter('[');
+    for(size_t i = 0; i < count(); i++)
+    {
+        if(i > 0)
+        {
+            sink.append(", ", 2);
+        }
+        if(_type == kInt64)
+        {
+            sink.appendValue(_ints[i]);
+        }
+        else
+        {
+            sink.appendValue(_doubles[i]);
+        }
+    }
+    sink.appendCharacter(']');
+}
+
+NS_HT_END(Huta)
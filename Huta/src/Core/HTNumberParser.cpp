@@ -0,0 +1,464 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTNumberParser.h>
+
+#include <cerrno>
+#include <cfloat>
+#include <clocale>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HT_PARSE_EIGHT_DIGITS 1
+#endif
+
+NS_HT_BEGIN(Huta)
+
+// 10^19 - 1 is the largest run of nines that fits in 64 bits
+static const int kMaxExactDigits = 19;
+
+// Exponents beyond this are out of range of every type, bigger ones are not accumulated
+static const int kExponentLimit = 100000;
+
+// Numerals this long or shorter are copied to the stack for strtod
+static const size_t kNumeralBufferSize = 128;
+
+static bool isDigit(char c)
+{
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+#if HT_PARSE_EIGHT_DIGITS
+// Return true if all eight bytes of chunk are ASCII digits
+static bool isEightDigits(uint64_t chunk)
+{
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+// Value of eight ASCII digits loaded little endian, first digit in the lowest byte.
+// Neighbouring digits are combined into pairs, pairs into fours and fours into the result
+static uint32_t eightDigitsValue(uint64_t chunk)
+{
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) + (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return static_cast<uint32_t>(chunk);
+}
+#endif
+
+// Accumulate the digits at p into value. Set overflow if the value does not fit 64 bits,
+// the digits are consumed anyway. Return the first character after the digits
+static const char* parseDigits(const char* p, const char* last, uint64_t& value, bool& overflow)
+{
+    value = 0;
+    overflow = false;
+
+#if HT_PARSE_EIGHT_DIGITS
+    // Two chunks of eight digits cannot overflow
+    for(int chunks = 0; chunks < 2 && last - p >= 8; ++chunks)
+    {
+        uint64_t chunk;
+        memcpy(&chunk, p, sizeof(chunk));
+        if(!isEightDigits(chunk))
+        {
+            break;
+        }
+        value = value * 100000000 + eightDigitsValue(chunk);
+        p += 8;
+    }
+#endif
+
+    while(p < last && isDigit(*p))
+    {
+        unsigned int digit = *p - '0';
+        if(overflow || value > (UINT64_MAX - digit) / 10)
+        {
+            overflow = true;
+        }
+        else
+        {
+            value = value * 10 + digit;
+        }
+        ++p;
+    }
+    return p;
+}
+
+static HTParseResult parseUnsigned(const char* first, const char* last, uint64_t maximum, uint64_t& value)
+{
+    HTParseResult result = { first, kHTParseInvalid };
+    if(first == last || !isDigit(*first))
+    {
+        return result;
+    }
+
+    bool overflow = false;
+    result.end = parseDigits(first, last, value, overflow);
+    result.status = overflow || value > maximum ? kHTParseOutOfRange : kHTParseSuccess;
+    return result;
+}
+
+static HTParseResult parseSigned(const char* first, const char* last, int64_t minimum, int64_t maximum, int64_t& value)
+{
+    HTParseResult result = { first, kHTParseInvalid };
+    bool negative = first < last && *first == '-';
+    const char* digits = first + (negative ? 1 : 0);
+    if(digits == last || !isDigit(*digits))
+    {
+        return result;
+    }
+
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    result.end = parseDigits(digits, last, magnitude, overflow);
+    uint64_t limit = negative ? static_cast<uint64_t>(-(minimum + 1)) + 1 : static_cast<uint64_t>(maximum);
+    if(overflow || magnitude > limit)
+    {
+        result.status = kHTParseOutOfRange;
+        return result;
+    }
+
+    // Negate without overflowing on the minimum
+    value = negative ? -static_cast<int64_t>(magnitude - 1) - 1 : static_cast<int64_t>(magnitude);
+    result.status = kHTParseSuccess;
+    return result;
+}
+
+HTParseResult HTNumberParser::parse(const char* first, const char* last, int& value)
+{
+    int64_t parsed = 0;
+    HTParseResult result = parseSigned(first, last, INT_MIN, INT_MAX, parsed);
+    if(result.status == kHTParseSuccess)
+    {
+        value = static_cast<int>(parsed);
+    }
+    return result;
+}
+
+HTParseResult HTNumberParser::parse(const char* first, const char* last, unsigned int& value)
+{
+    uint64_t parsed = 0;
+    HTParseResult result = parseUnsigned(first, last, UINT_MAX, parsed);
+    if(result.status == kHTParseSuccess)
+    {
+        value = static_cast<unsigned int>(parsed);
+    }
+    return result;
+}
+
+HTParseResult HTNumberParser::parse(const char* first, const char* last, int64_t& value)
+{
+    int64_t parsed = 0;
+    HTParseResult result = parseSigned(first, last, INT64_MIN, INT64_MAX, parsed);
+    if(result.status == kHTParseSuccess)
+    {
+        value = parsed;
+    }
+    return result;
+}
+
+HTParseResult HTNumberParser::parse(const char* first, const char* last, uint64_t& value)
+{
+    uint64_t parsed = 0;
+    HTParseResult result = parseUnsigned(first, last, UINT64_MAX, parsed);
+    if(result.status == kHTParseSuccess)
+    {
+        value = parsed;
+    }
+    return result;
+}
+
+// Limits of the exact path: a mantissa below 2^digits and a power of ten that is exact
+// in the type give a correctly rounded result with one rounding
+template<typename T>
+struct HTFloatingTraits;
+
+template<>
+struct HTFloatingTraits<double>
+{
+    static const uint64_t kMaxExactMantissa = 1ULL << 53;
+    static const int kMaxExactExponent = 22;
+
+    static double powerOfTen(int exponent)
+    {
+        static const double powers[] =
+        {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        return powers[exponent];
+    }
+
+    static double convert(const char* numeral, char** end)
+    {
+        return strtod(numeral, end);
+    }
+};
+
+template<>
+struct HTFloatingTraits<float>
+{
+    static const uint64_t kMaxExactMantissa = 1ULL << 24;
+    static const int kMaxExactExponent = 10;
+
+    static float powerOfTen(int exponent)
+    {
+        static const float powers[] =
+        {
+            1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+        };
+        return powers[exponent];
+    }
+
+    static float convert(const char* numeral, char** end)
+    {
+        return strtof(numeral, end);
+    }
+};
+
+// Compare the word at p with a lower case keyword, ignoring case
+static bool matchesKeyword(const char* p, const char* last, const char* keyword)
+{
+    size_t length = strlen(keyword);
+    if(static_cast<size_t>(last - p) < length)
+    {
+        return false;
+    }
+    for(size_t i = 0; i < length; ++i)
+    {
+        if((p[i] | 0x20) != keyword[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Convert a numeral that is already checked with strtod. The decimal point is swapped
+// for the one of the C locale, which is what makes strtod depend on the locale
+template<typename T>
+static HTParseStatus convertSlowly(const char* first, const char* last, T& value)
+{
+    const char* point = localeconv()->decimal_point;
+    size_t pointLength = strlen(point);
+    size_t length = static_cast<size_t>(last - first);
+
+    std::string copy;
+    char buffer[kNumeralBufferSize];
+    char* numeral = buffer;
+    if(length + pointLength >= kNumeralBufferSize)
+    {
+        copy.resize(length + pointLength);
+        numeral = &copy[0];
+    }
+
+    char* out = numeral;
+    for(const char* p = first; p < last; ++p)
+    {
+        if(*p == '.')
+        {
+            memcpy(out, point, pointLength);
+            out += pointLength;
+        }
+        else
+        {
+            *out++ = *p;
+        }
+    }
+    *out = '\0';
+
+    // ERANGE covers overflow and underflow, "1e-400" is out of range like for std::stod
+    errno = 0;
+    T result = HTFloatingTraits<T>::convert(numeral, nullptr);
+    if(errno == ERANGE)
+    {
+        return kHTParseOutOfRange;
+    }
+    value = result;
+    return kHTParseSuccess;
+}
+
+template<typename T>
+static HTParseResult parseFloating(const char* first, const char* last, T& value)
+{
+    HTParseResult result = { first, kHTParseInvalid };
+    const char* p = first;
+    bool negative = p < last && *p == '-';
+    if(negative)
+    {
+        ++p;
+    }
+
+    if(p < last && !isDigit(*p) && *p != '.')
+    {
+        const char* end = nullptr;
+        T special = 0;
+        if(matchesKeyword(p, last, "infinity"))
+        {
+            end = p + 8;
+            special = std::numeric_limits<T>::infinity();
+        }
+        else if(matchesKeyword(p, last, "inf"))
+        {
+            end = p + 3;
+            special = std::numeric_limits<T>::infinity();
+        }
+        else if(matchesKeyword(p, last, "nan"))
+        {
+            end = p + 3;
+            special = std::numeric_limits<T>::quiet_NaN();
+        }
+        if(end != nullptr)
+        {
+            value = negative ? -special : special;
+            result.end = end;
+            result.status = kHTParseSuccess;
+        }
+        return result;
+    }
+
+    // Significant digits go to mantissa, exponent counts the powers of ten they are off by
+    uint64_t mantissa = 0;
+    int digitCount = 0;
+    int64_t exponent = 0;
+    bool sawDigits = false;
+    bool manyDigits = false;
+
+    while(p < last && isDigit(*p))
+    {
+        sawDigits = true;
+        unsigned int digit = *p - '0';
+        if(digitCount < kMaxExactDigits)
+        {
+            mantissa = mantissa * 10 + digit;
+            digitCount += mantissa != 0 ? 1 : 0;
+        }
+        else
+        {
+            ++exponent;
+            manyDigits = true;
+        }
+        ++p;
+    }
+
+    if(p < last && *p == '.')
+    {
+        ++p;
+        while(p < last && isDigit(*p))
+        {
+            sawDigits = true;
+            unsigned int digit = *p - '0';
+            if(digitCount < kMaxExactDigits)
+            {
+                mantissa = mantissa * 10 + digit;
+                digitCount += mantissa != 0 ? 1 : 0;
+                --exponent;
+            }
+            else
+            {
+                manyDigits = true;
+            }
+            ++p;
+        }
+    }
+
+    // A lone point is not a numeral, "5." and ".5" are
+    if(!sawDigits)
+    {
+        return result;
+    }
+
+    // An exponent without digits is not part of the numeral
+    if(p < last && (*p == 'e' || *p == 'E'))
+    {
+        const char* q = p + 1;
+        bool negativeExponent = false;
+        if(q < last && (*q == '+' || *q == '-'))
+        {
+            negativeExponent = *q == '-';
+            ++q;
+        }
+        if(q < last && isDigit(*q))
+        {
+            int64_t written = 0;
+            while(q < last && isDigit(*q))
+            {
+                if(written < kExponentLimit)
+                {
+                    written = written * 10 + (*q - '0');
+                }
+                ++q;
+            }
+            exponent += negativeExponent ? -written : written;
+            p = q;
+        }
+    }
+    result.end = p;
+
+    if(mantissa == 0)
+    {
+        value = negative ? -static_cast<T>(0) : static_cast<T>(0);
+        result.status = kHTParseSuccess;
+        return result;
+    }
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    // Both operands are exact, so the one rounding of the division or multiplication is
+    // the correct rounding. Extended precision intermediates would round twice
+    if(!manyDigits && mantissa <= HTFloatingTraits<T>::kMaxExactMantissa &&
+       exponent >= -HTFloatingTraits<T>::kMaxExactExponent && exponent <= HTFloatingTraits<T>::kMaxExactExponent)
+    {
+        T converted = static_cast<T>(mantissa);
+        if(exponent < 0)
+        {
+            converted /= HTFloatingTraits<T>::powerOfTen(static_cast<int>(-exponent));
+        }
+        else
+        {
+            converted *= HTFloatingTraits<T>::powerOfTen(static_cast<int>(exponent));
+        }
+        value = negative ? -converted : converted;
+        result.status = kHTParseSuccess;
+        return result;
+    }
+#endif
+
+    result.status = convertSlowly(first, result.end, value);
+    return result;
+}
+
+HTParseResult HTNumberParser::parse(const char* first, const char* last, float& value)
+{
+    return parseFloating(first, last, value);
+}
+
+HTParseResult HTNumberParser::parse(const char* first, const char* last, double& value)
+{
+    return parseFloating(first, last, value);
+}
+
+NS_HT_END(Huta)
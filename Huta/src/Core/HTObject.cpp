@@ -21,14 +21,22 @@
 // THE SOFTWARE.
 
 #include <Core/HTObject.h>
+#include <Core/HTHash.h>
 #include <Core/HTAutoreleasePool.h>
 #include <Core/HTString.h>
+#include <Core/HTOutputSink.h>
 
-#include <sstream>
 #include <algorithm>    // std::find
+#include <cstdio>
 #include <list>
+#include <functional>
+#include <cstdint>
 
 NS_HT_BEGIN(Huta)
+
+const unsigned int HTObject::kImmortalReferenceCount;
+const size_t HTObject::kDefaultDescriptionDepth;
+
 #ifdef HT_MEM_LEAK_TRACK
 static void trackRef(HTRef* ref);
 static void untrackRef(HTRef* ref);
@@ -53,14 +61,21 @@ HTObject::~HTObject()
 
 HTObject* HTObject::retain()
 {
-    ++_referenceCount;
+    if(isImmortal())
+    {
+        return this;
+    }
+    _referenceCount.fetch_add(1, std::memory_order_relaxed);
     return this;
 }
 
 void HTObject::release()
 {
-    --_referenceCount;
-    if(_referenceCount == 0)
+    if(isImmortal())
+    {
+        return;
+    }
+    if(_referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
     {
 #ifdef HT_MEM_LEAK_TRACK
         untrackRef(this);
@@ -69,27 +84,200 @@ void HTObject::release()
     }
 }
 
+void HTObject::makeImmortal()
+{
+#ifdef HT_MEM_LEAK_TRACK
+    // Immortal objects are never freed, they are not leaks
+    if(!isImmortal())
+    {
+        untrackRef(this);
+    }
+#endif
+    _referenceCount.store(kImmortalReferenceCount | (kImmortalReferenceCount >> 1), std::memory_order_relaxed);
+}
+
 bool HTObject::isEqual(const HTObject* other) 
 {
     return (other == this);
 }
 
+size_t HTObject::hash() const
+{
+    // Mix the address, its low bits are always zero because of alignment
+    return static_cast<size_t>(HTHash::mix(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this))));
+}
+
 HTObject* HTObject::autorelease()
 {
+    if(isImmortal())
+    {
+        return this;
+    }
     HTPoolManager::getInstance()->getCurrentPool()->addObject(this);
     return this;
 }
 
 unsigned int HTObject::getReferenceCount() const
 {
-    return _referenceCount;
+    return _referenceCount.load(std::memory_order_relaxed);
 }
 
 HTString* HTObject::toString() const
 {
-    std::stringstream ss;
-    ss << this;
-    return HTString::create(ss.str());
+    HTStringOutputSink sink;
+    describeTo(sink);
+    return HTString::create(sink.takeString());
+}
+
+static void describeAddress(HTOutputSink& sink, const void* address)
+{
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%p", address);
+    if(length > 0)
+    {
+        sink.append(buffer, static_cast<size_t>(length));
+    }
+}
+
+void HTObject::describeSelfTo(HTOutputSink& sink) const
+{
+    describeAddress(sink, this);
+}
+
+HTDescriptionKind HTObject::getDescriptionKind() const
+{
+    return kHTDescriptionLeaf;
+}
+
+void HTObject::getDescriptionElements(std::vector<HTRef*>& elements) const
+{
+
+}
+
+// Steps are pushed in reverse and popped in order. A container pushes its closing step
+// first, then its elements from the last to the first, so the stack holds the unwritten
+// elements of the containers being written and nothing else. The path is the list of
+// those containers, checked for cycles; it is never longer than maxDepth. Both live in
+// the sink and only grow above the size they had on entry, so describeSelfTo may call
+// describeTo with the same sink.
+void HTObject::describeTo(HTOutputSink& sink, size_t maxDepth) const
+{
+    std::vector<HTOutputSink::DescriptionStep>& steps = sink._descriptionSteps;
+    std::vector<const HTObject*>& path = sink._descriptionPath;
+    std::vector<HTRef*>& elements = sink._descriptionElements;
+    size_t base = steps.size();
+
+    HTOutputSink::DescriptionStep first = { this, 0, '\0', '\0' };
+    steps.push_back(first);
+    while(steps.size() > base)
+    {
+        HTOutputSink::DescriptionStep step = steps.back();
+        steps.pop_back();
+
+        if(step.prefix == ',')
+        {
+            sink.append(", ", 2);
+        }
+        else if(step.prefix == ':')
+        {
+            sink.append(": ", 2);
+        }
+
+        if(step.close != '\0')
+        {
+            sink.appendCharacter(step.close);
+            path.pop_back();
+            continue;
+        }
+
+        if(step.object == nullptr)
+        {
+            sink.append("(null)", 6);
+            continue;
+        }
+        const HTObject* object = dynamic_cast<const HTObject*>(step.object);
+        if(object == nullptr)
+        {
+            describeAddress(sink, step.object);
+            continue;
+        }
+
+        HTDescriptionKind kind = object->getDescriptionKind();
+        if(kind == kHTDescriptionLeaf)
+        {
+            object->describeSelfTo(sink);
+            continue;
+        }
+
+        char open = kind == kHTDescriptionList ? '[' : '{';
+        char close = kind == kHTDescriptionList ? ']' : '}';
+        if(step.depth >= maxDepth)
+        {
+            sink.appendCharacter(open);
+            sink.append("...", 3);
+            sink.appendCharacter(close);
+            continue;
+        }
+        if(std::find(path.begin(), path.end(), object) != path.end())
+        {
+            sink.append("(cycle)", 7);
+            continue;
+        }
+
+        path.push_back(object);
+        sink.appendCharacter(open);
+        HTOutputSink::DescriptionStep closing = { object, step.depth, '\0', close };
+        steps.push_back(closing);
+
+        elements.clear();
+        object->getDescriptionElements(elements);
+        uint32_t depth = step.depth + 1;
+        size_t count = elements.size();
+        if(kind == kHTDescriptionMap)
+        {
+            for(size_t i = count / 2; i-- > 0;)
+            {
+                HTOutputSink::DescriptionStep value = { elements[2 * i + 1], depth, ':', '\0' };
+                HTOutputSink::DescriptionStep key = { elements[2 * i], depth, i > 0 ? ',' : '\0', '\0' };
+                steps.push_back(value);
+                steps.push_back(key);
+            }
+        }
+        else
+        {
+            for(size_t i = count; i-- > 0;)
+            {
+                HTOutputSink::DescriptionStep element = { elements[i], depth, i > 0 ? ',' : '\0', '\0' };
+                steps.push_back(element);
+            }
+        }
+    }
+}
+
+size_t HTRefHasher::operator()(HTRef* ref) const
+{
+    const HTObject* object = dynamic_cast<const HTObject*>(ref);
+    if(object != nullptr)
+    {
+        return object->hash();
+    }
+    return std::hash<HTRef*>()(ref);
+}
+
+bool HTRefEqual::operator()(HTRef* ref, HTRef* other) const
+{
+    if(ref == other)
+    {
+        return true;
+    }
+
+    HTObject* object = dynamic_cast<HTObject*>(ref);
+    HTObject* otherObject = dynamic_cast<HTObject*>(other);
+    if(object == nullptr || otherObject == nullptr)
+    {
+        return false;
+    }
+    return object->isEqual(otherObject);
 }
 
 #ifdef HT_MEM_LEAK_TRACK
@@ -0,0 +1,152 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include <Core/HTOutputSink.h>
+
+#include <cerrno>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+NS_HT_BEGIN(Huta)
+
+const size_t HTOutputSink::kDefaultBufferSize;
+
+// Room past the buffer size for a value appended by appendValue before the flush
+static const size_t kValueReserve = 32;
+
+HTOutputSink::HTOutputSink(size_t bufferSize)
+: _bufferSize(bufferSize > 0 ? bufferSize : 1)
+{
+    if(_bufferSize <= kDefaultBufferSize * 16)
+    {
+        _buffer.reserve(_bufferSize + kValueReserve);
+    }
+}
+
+HTOutputSink::~HTOutputSink()
+{
+
+}
+
+void HTOutputSink::appendLarge(const char* data, size_t length)
+{
+    flush();
+    if(length >= _bufferSize)
+    {
+        // Would fill the buffer on its own, write it straight through
+        write(data, length);
+        return;
+    }
+    _buffer.append(data, length);
+}
+
+void HTOutputSink::appendValue(const HTFormatArgument& value)
+{
+    value.appendTo(_buffer);
+    if(_buffer.size() >= _bufferSize)
+    {
+        flush();
+    }
+}
+
+void HTOutputSink::flush()
+{
+    if(!_buffer.empty())
+    {
+        write(_buffer.data(), _buffer.size());
+        _buffer.clear();
+    }
+}
+
+HTStringOutputSink::HTStringOutputSink()
+: HTOutputSink(SIZE_MAX)
+{
+
+}
+
+std::string HTStringOutputSink::takeString()
+{
+    std::string string;
+    string.swap(_buffer);
+    return string;
+}
+
+void HTStringOutputSink::flush()
+{
+
+}
+
+void HTStringOutputSink::write(const char* data, size_t length)
+{
+    _buffer.append(data, length);
+}
+
+HTFileOutputSink::HTFileOutputSink(int descriptor, bool closeWhenDone, size_t bufferSize)
+: HTOutputSink(bufferSize)
+, _descriptor(descriptor)
+, _closeWhenDone(closeWhenDone)
+, _failed(descriptor < 0)
+{
+
+}
+
+HTFileOutputSink::~HTFileOutputSink()
+{
+    flush();
+    if(_closeWhenDone && _descriptor >= 0)
+    {
+#if defined(_WIN32)
+        _close(_descriptor);
+#else
+        close(_descriptor);
+#endif
+    }
+}
+
+void HTFileOutputSink::write(const char* data, size_t length)
+{
+    // Partial writes happen on pipes and sockets, keep going until everything is out
+    while(length > 0 && !_failed)
+    {
+#if defined(_WIN32)
+        int written = _write(_descriptor, data, static_cast<unsigned int>(length < 0x40000000 ? length : 0x40000000));
+#else
+        ssize_t written = ::write(_descriptor, data, length);
+#endif
+        if(written < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            _failed = true;
+            break;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+}
+
+NS_HT_END(Huta)
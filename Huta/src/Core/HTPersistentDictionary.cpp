@@ -0,0 +1,684 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTPersistentDictionary.h>
+#include <Core/HTException.h>
+
+#include <atomic>
+#include <vector>
+
+NS_HT_BEGIN(Huta)
+
+//--------------------------------------------------------------------
+//
+// Trie nodes
+//
+//--------------------------------------------------------------------
+
+static const unsigned int kHAMTBits = 5;
+static const size_t kHAMTMask = (1 << kHAMTBits) - 1;
+
+struct HTHAMTNode
+{
+    HTHAMTNode(bool leaf, uint64_t editId)
+    : refs(1)
+    , isLeaf(leaf)
+    , edit(editId)
+    {}
+
+    std::atomic<unsigned int> refs;
+    const bool isLeaf;
+    // Id of the transient allowed to update this node in place, 0 if none
+    const uint64_t edit;
+};
+
+// Entries with the same full hash are chained through next
+struct HTHAMTLeaf: public HTHAMTNode
+{
+    HTHAMTLeaf(size_t keyHash, HTRef* aKey, HTRef* aValue, HTHAMTLeaf* nextLeaf, uint64_t editId)
+    : HTHAMTNode(true, editId)
+    , hash(keyHash)
+    , key(aKey)
+    , value(aValue)
+    , next(nextLeaf)
+    {}
+
+    size_t hash;
+    HTRefPtr<HTRef> key;
+    HTRefPtr<HTRef> value;
+    HTHAMTLeaf* next;
+};
+
+struct HTHAMTBranch: public HTHAMTNode
+{
+    explicit HTHAMTBranch(uint64_t editId)
+    : HTHAMTNode(false, editId)
+    , bitmap(0)
+    {}
+
+    uint32_t bitmap;
+    std::vector<HTHAMTNode*> children;
+};
+
+static std::atomic<uint64_t> s_nextEdit(1);
+
+static uint64_t newEdit()
+{
+    return s_nextEdit.fetch_add(1, std::memory_order_relaxed);
+}
+
+static inline unsigned int popCount(uint32_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_popcount(value);
+#else
+    value = value - ((value >> 1) & 0x55555555);
+    value = (value & 0x33333333) + ((value >> 2) & 0x33333333);
+    return (((value + (value >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+}
+
+static inline HTHAMTNode* retainNode(HTHAMTNode* node)
+{
+    if(node)
+    {
+        node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return node;
+}
+
+static void releaseNode(HTHAMTNode* node)
+{
+    while(node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        if(node->isLeaf)
+        {
+            HTHAMTLeaf* leaf = static_cast<HTHAMTLeaf*>(node);
+            node = leaf->next;
+            delete leaf;
+        }
+        else
+        {
+            HTHAMTBranch* branch = static_cast<HTHAMTBranch*>(node);
+            for(auto child: branch->children)
+            {
+                releaseNode(child);
+            }
+            delete branch;
+            node = nullptr;
+        }
+    }
+}
+
+static inline size_t slotOf(size_t hash, unsigned int shift)
+{
+    return (hash >> shift) & kHAMTMask;
+}
+
+static HTRef* lookup(const HTHAMTNode* node, size_t hash, HTRef* key)
+{
+    HTRefEqual equal;
+    unsigned int shift = 0;
+    while(node)
+    {
+        if(node->isLeaf)
+        {
+            const HTHAMTLeaf* leaf = static_cast<const HTHAMTLeaf*>(node);
+            if(leaf->hash != hash)
+            {
+                return nullptr;
+            }
+            for(; leaf; leaf = leaf->next)
+            {
+                if(equal(leaf->key.get(), key))
+                {
+                    return leaf->value.get();
+                }
+            }
+            return nullptr;
+        }
+
+        const HTHAMTBranch* branch = static_cast<const HTHAMTBranch*>(node);
+        uint32_t bit = 1u << slotOf(hash, shift);
+        if((branch->bitmap & bit) == 0)
+        {
+            return nullptr;
+        }
+        node = branch->children[popCount(branch->bitmap & (bit - 1))];
+        shift += kHAMTBits;
+    }
+    return nullptr;
+}
+
+// Branch holding two leaves with different hashes. Takes ownership of both
+static HTHAMTNode* mergeLeaves(HTHAMTLeaf* leaf, HTHAMTLeaf* other, unsigned int shift, uint64_t edit)
+{
+    HTHAMTBranch* branch = new HTHAMTBranch(edit);
+    size_t slot = slotOf(leaf->hash, shift);
+    size_t otherSlot = slotOf(other->hash, shift);
+    if(slot == otherSlot)
+    {
+        branch->bitmap = 1u << slot;
+        branch->children.push_back(mergeLeaves(leaf, other, shift + kHAMTBits, edit));
+    }
+    else
+    {
+        branch->bitmap = (1u << slot) | (1u << otherSlot);
+        branch->children.reserve(2);
+        branch->children.push_back(slot < otherSlot ? leaf : other);
+        branch->children.push_back(slot < otherSlot ? other : leaf);
+    }
+    return branch;
+}
+
+// Copy a collision chain up to the entry stop and link the copy to rest
+static HTHAMTLeaf* copyChain(HTHAMTLeaf* head, HTHAMTLeaf* stop, HTHAMTLeaf* rest, uint64_t edit)
+{
+    if(head == stop)
+    {
+        return static_cast<HTHAMTLeaf*>(retainNode(rest));
+    }
+    return new HTHAMTLeaf(head->hash, head->key.get(), head->value.get(),
+                          copyChain(head->next, stop, rest, edit), edit);
+}
+
+// Return the node with key matched to value. The result is owned by the caller,
+// it's the same node (retained again) if nothing had to be copied
+static HTHAMTNode* assoc(HTHAMTNode* node, unsigned int shift, size_t hash,
+                         HTRef* key, HTRef* value, uint64_t edit, bool& added)
+{
+    if(node == nullptr)
+    {
+        added = true;
+        return new HTHAMTLeaf(hash, key, value, nullptr, edit);
+    }
+
+    if(node->isLeaf)
+    {
+        HTHAMTLeaf* leaf = static_cast<HTHAMTLeaf*>(node);
+        if(leaf->hash != hash)
+        {
+            added = true;
+            return mergeLeaves(static_cast<HTHAMTLeaf*>(retainNode(leaf)),
+                               new HTHAMTLeaf(hash, key, value, nullptr, edit), shift, edit);
+        }
+
+        HTRefEqual equal;
+        for(HTHAMTLeaf* entry = leaf; entry; entry = entry->next)
+        {
+            if(!equal(entry->key.get(), key))
+            {
+                continue;
+            }
+            if(entry->value.get() == value)
+            {
+                return retainNode(node);
+            }
+            if(edit != 0 && entry->edit == edit)
+            {
+                entry->value = value;
+                return retainNode(node);
+            }
+            HTHAMTLeaf* replaced = new HTHAMTLeaf(hash, entry->key.get(), value,
+                                                  static_cast<HTHAMTLeaf*>(retainNode(entry->next)), edit);
+            HTHAMTLeaf* head = copyChain(leaf, entry, replaced, edit);
+            releaseNode(replaced);
+            return head;
+        }
+
+        // Full hash collision, prepend to the chain
+        added = true;
+        return new HTHAMTLeaf(hash, key, value, static_cast<HTHAMTLeaf*>(retainNode(leaf)), edit);
+    }
+
+    HTHAMTBranch* branch = static_cast<HTHAMTBranch*>(node);
+    uint32_t bit = 1u << slotOf(hash, shift);
+    size_t index = popCount(branch->bitmap & (bit - 1));
+    bool inPlace = (edit != 0 && branch->edit == edit);
+
+    if(branch->bitmap & bit)
+    {
+        HTHAMTNode* child = branch->children[index];
+        HTHAMTNode* newChild = assoc(child, shift + kHAMTBits, hash, key, value, edit, added);
+        if(newChild == child)
+        {
+            releaseNode(newChild);
+            return retainNode(node);
+        }
+        if(inPlace)
+        {
+            branch->children[index] = newChild;
+            releaseNode(child);
+            return retainNode(node);
+        }
+
+        HTHAMTBranch* copy = new HTHAMTBranch(edit);
+        copy->bitmap = branch->bitmap;
+        copy->children = branch->children;
+        for(size_t i = 0; i < copy->children.size(); ++i)
+        {
+            if(i != index)
+            {
+                retainNode(copy->children[i]);
+            }
+        }
+        copy->children[index] = newChild;
+        return copy;
+    }
+
+    added = true;
+    HTHAMTNode* newLeaf = new HTHAMTLeaf(hash, key, value, nullptr, edit);
+    if(inPlace)
+    {
+        branch->bitmap |= bit;
+        branch->children.insert(branch->children.begin() + index, newLeaf);
+        return retainNode(node);
+    }
+
+    HTHAMTBranch* copy = new HTHAMTBranch(edit);
+    copy->bitmap = branch->bitmap | bit;
+    copy->children.reserve(branch->children.size() + 1);
+    copy->children.insert(copy->children.end(), branch->children.begin(), branch->children.begin() + index);
+    copy->children.push_back(newLeaf);
+    copy->children.insert(copy->children.end(), branch->children.begin() + index, branch->children.end());
+    for(size_t i = 0; i < copy->children.size(); ++i)
+    {
+        if(i != index)
+        {
+            retainNode(copy->children[i]);
+        }
+    }
+    return copy;
+}
+
+// Return the node without key, nullptr if it became empty. Ownership as assoc()
+static HTHAMTNode* dissoc(HTHAMTNode* node, unsigned int shift, size_t hash,
+                          HTRef* key, uint64_t edit, bool& removed)
+{
+    if(node->isLeaf)
+    {
+        HTHAMTLeaf* leaf = static_cast<HTHAMTLeaf*>(node);
+        if(leaf->hash != hash)
+        {
+            return retainNode(node);
+        }
+
+        HTRefEqual equal;
+        for(HTHAMTLeaf* entry = leaf; entry; entry = entry->next)
+        {
+            if(equal(entry->key.get(), key))
+            {
+                removed = true;
+                return copyChain(leaf, entry, entry->next, edit);
+            }
+        }
+        return retainNode(node);
+    }
+
+    HTHAMTBranch* branch = static_cast<HTHAMTBranch*>(node);
+    uint32_t bit = 1u << slotOf(hash, shift);
+    if((branch->bitmap & bit) == 0)
+    {
+        return retainNode(node);
+    }
+
+    size_t index = popCount(branch->bitmap & (bit - 1));
+    HTHAMTNode* child = branch->children[index];
+    HTHAMTNode* newChild = dissoc(child, shift + kHAMTBits, hash, key, edit, removed);
+    if(newChild == child)
+    {
+        releaseNode(newChild);
+        return retainNode(node);
+    }
+
+    size_t remaining = branch->children.size() - (newChild ? 0 : 1);
+    if(remaining == 0)
+    {
+        return nullptr;
+    }
+
+    // Keep the trie canonical, a branch with a single leaf collapses into the leaf
+    if(remaining == 1)
+    {
+        HTHAMTNode* last = newChild ? newChild : branch->children[index == 0 ? 1 : 0];
+        if(last->isLeaf)
+        {
+            return newChild ? newChild : retainNode(last);
+        }
+    }
+
+    if(edit != 0 && branch->edit == edit)
+    {
+        if(newChild)
+        {
+            branch->children[index] = newChild;
+        }
+        else
+        {
+            branch->bitmap &= ~bit;
+            branch->children.erase(branch->children.begin() + index);
+        }
+        releaseNode(child);
+        return retainNode(node);
+    }
+
+    HTHAMTBranch* copy = new HTHAMTBranch(edit);
+    copy->bitmap = newChild ? branch->bitmap : (branch->bitmap & ~bit);
+    copy->children.reserve(remaining);
+    for(size_t i = 0; i < branch->children.size(); ++i)
+    {
+        if(i != index)
+        {
+            copy->children.push_back(retainNode(branch->children[i]));
+        }
+        else if(newChild)
+        {
+            copy->children.push_back(newChild);
+        }
+    }
+    return copy;
+}
+
+// Return false if the callback stopped the enumeration
+template <typename F>
+static bool enumerate(const HTHAMTNode* node, F&& callback)
+{
+    if(node == nullptr)
+    {
+        return true;
+    }
+
+    if(node->isLeaf)
+    {
+        for(const HTHAMTLeaf* leaf = static_cast<const HTHAMTLeaf*>(node); leaf; leaf = leaf->next)
+        {
+            if(!callback(leaf->key.get(), leaf->value.get()))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    for(auto child: static_cast<const HTHAMTBranch*>(node)->children)
+    {
+        if(!enumerate(child, callback))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void checkEntry(HTRef* object, HTRef* key)
+{
+    if(key == nullptr)
+    {
+        throw HTException("Dictionary key must not be nullptr");
+    }
+    if(object == nullptr)
+    {
+        throw HTException("Dictionary object must not be nullptr");
+    }
+}
+
+//--------------------------------------------------------------------
+//
+// HTPersistentDictionary
+//
+//--------------------------------------------------------------------
+
+HTPersistentDictionary* HTPersistentDictionary::create()
+{
+    HTPersistentDictionary* object = new HTPersistentDictionary();
+    if(object && object->init())
+    {
+        object->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(object);
+    }
+    return object;
+}
+
+HTPersistentDictionary* HTPersistentDictionary::createWithDictionary(HTDictionary* other)
+{
+    HTTransientDictionary* transient = HTTransientDictionary::create();
+    HTArray* keys = other->allKeys();
+    for(auto it = keys->begin(); it != keys->end(); ++it)
+    {
+        transient->setObject(other->objectForKey(it->get()), it->get());
+    }
+    return transient->persistent();
+}
+
+HTPersistentDictionary::HTPersistentDictionary()
+: _root(nullptr)
+, _count(0)
+{
+
+}
+
+HTPersistentDictionary::~HTPersistentDictionary()
+{
+    releaseNode(_root);
+}
+
+bool HTPersistentDictionary::init()
+{
+    return true;
+}
+
+size_t HTPersistentDictionary::count() const
+{
+    return _count;
+}
+
+HTArray* HTPersistentDictionary::allKeys() const
+{
+    HTArray* array = HTArray::createWithCapacity(_count);
+    enumerate(_root, [array](HTRef* key, HTRef* value) {
+        array->addObject(key);
+        return true;
+    });
+    return array;
+}
+
+HTArray* HTPersistentDictionary::allObjects() const
+{
+    HTArray* array = HTArray::createWithCapacity(_count);
+    enumerate(_root, [array](HTRef* key, HTRef* value) {
+        array->addObject(value);
+        return true;
+    });
+    return array;
+}
+
+void HTPersistentDictionary::enumerateKeysAndObjects(const std::function<void(HTRef* key, HTRef* object, bool* stop)>& callback) const
+{
+    bool stop = false;
+    enumerate(_root, [&callback, &stop](HTRef* key, HTRef* value) {
+        callback(key, value, &stop);
+        return !stop;
+    });
+}
+
+HTRef* HTPersistentDictionary::objectForKey(HTRef* key) const
+{
+    if(key == nullptr)
+    {
+        return nullptr;
+    }
+    return lookup(_root, HTRefHasher()(key), key);
+}
+
+HTPersistentDictionary* HTPersistentDictionary::setObject(HTRef* object, HTRef* key) const
+{
+    checkEntry(object, key);
+
+    bool added = false;
+    HTPersistentDictionary* version = HTPersistentDictionary::create();
+    version->_root = assoc(_root, 0, HTRefHasher()(key), key, object, 0, added);
+    version->_count = _count + (added ? 1 : 0);
+    return version;
+}
+
+HTPersistentDictionary* HTPersistentDictionary::removeObjectForKey(HTRef* key) const
+{
+    bool removed = false;
+    HTPersistentDictionary* version = HTPersistentDictionary::create();
+    if(key != nullptr && _root != nullptr)
+    {
+        version->_root = dissoc(_root, 0, HTRefHasher()(key), key, 0, removed);
+    }
+    else
+    {
+        version->_root = retainNode(_root);
+    }
+    version->_count = _count - (removed ? 1 : 0);
+    return version;
+}
+
+HTTransientDictionary* HTPersistentDictionary::transient() const
+{
+    HTTransientDictionary* transient = HTTransientDictionary::create();
+    transient->_root = retainNode(_root);
+    transient->_count = _count;
+    return transient;
+}
+
+HTDictionary* HTPersistentDictionary::toDictionary() const
+{
+    HTDictionary* dictionary = HTDictionary::create();
+    enumerate(_root, [dictionary](HTRef* key, HTRef* value) {
+        dictionary->setObject(value, key);
+        return true;
+    });
+    return dictionary;
+}
+
+//--------------------------------------------------------------------
+//
+// HTTransientDictionary
+//
+//--------------------------------------------------------------------
+
+HTTransientDictionary* HTTransientDictionary::create()
+{
+    HTTransientDictionary* object = new HTTransientDictionary();
+    if(object && object->init())
+    {
+        object->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(object);
+    }
+    return object;
+}
+
+HTTransientDictionary::HTTransientDictionary()
+: _root(nullptr)
+, _count(0)
+, _edit(0)
+{
+
+}
+
+HTTransientDictionary::~HTTransientDictionary()
+{
+    releaseNode(_root);
+}
+
+bool HTTransientDictionary::init()
+{
+    _edit = newEdit();
+    return true;
+}
+
+size_t HTTransientDictionary::count() const
+{
+    return _count;
+}
+
+HTRef* HTTransientDictionary::objectForKey(HTRef* key) const
+{
+    if(key == nullptr)
+    {
+        return nullptr;
+    }
+    return lookup(_root, HTRefHasher()(key), key);
+}
+
+void HTTransientDictionary::setObject(HTRef* object, HTRef* key)
+{
+    checkEntry(object, key);
+
+    bool added = false;
+    HTHAMTNode* root = assoc(_root, 0, HTRefHasher()(key), key, object, _edit, added);
+    releaseNode(_root);
+    _root = root;
+    _count += (added ? 1 : 0);
+}
+
+void HTTransientDictionary::removeObjectForKey(HTRef* key)
+{
+    if(key == nullptr || _root == nullptr)
+    {
+        return;
+    }
+
+    bool removed = false;
+    HTHAMTNode* root = dissoc(_root, 0, HTRefHasher()(key), key, _edit, removed);
+    releaseNode(_root);
+    _root = root;
+    _count -= (removed ? 1 : 0);
+}
+
+HTPersistentDictionary* HTTransientDictionary::persistent()
+{
+    HTPersistentDictionary* version = HTPersistentDictionary::create();
+    version->_root = retainNode(_root);
+    version->_count = _count;
+
+    // Nodes are shared with the version from now on, stop updating them in place
+    _edit = newEdit();
+    return version;
+}
+
+HTDescriptionKind HTPersistentDictionary::getDescriptionKind() const
+{
+    return kHTDescriptionMap;
+}
+
+void HTPersistentDictionary::getDescriptionElements(std::vector<HTRef*>& elements) const
+{
+    elements.reserve(elements.size() + _count * 2);
+    enumerate(_root, [&elements](HTRef* key, HTRef* value) {
+        elements.push_back(key);
+        elements.push_back(value);
+        return true;
+    });
+}
+
+NS_HT_END(Huta)
@@ -0,0 +1,1221 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTRegex.h>
+#include <Core/HTString.h>
+#include <Core/HTArray.h>
+#include <Core/HTCache.h>
+
+#include <memory>
+#include <algorithm>
+
+NS_HT_BEGIN(Huta)
+
+// Limits that keep compiling a hostile pattern cheap
+static const int kMaxRepeatCount = 1000;
+static const size_t kMaxProgramSize = 20000;
+static const size_t kMaxNestingDepth = 250;
+static const size_t kCacheCountLimit = 256;
+static const size_t kNoPosition = static_cast<size_t>(-1);
+
+static bool isWordByte(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Bytes of \d, \w and \s
+static std::bitset<256> escapeSet(char escape)
+{
+    std::bitset<256> set;
+    for(int c = 0; c < 256; ++c)
+    {
+        switch(escape)
+        {
+            case 'd':
+                set[c] = c >= '0' && c <= '9';
+                break;
+            case 'w':
+                set[c] = isWordByte(static_cast<unsigned char>(c));
+                break;
+            case 's':
+                set[c] = c == ' ' || (c >= '\t' && c <= '\r');
+                break;
+        }
+    }
+    return set;
+}
+
+static int hexValue(char c)
+{
+    if(c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if(c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if(c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+//--------------------------------------------------------------------
+//
+// Parser, pattern to syntax tree
+//
+//--------------------------------------------------------------------
+
+struct HTRegex::Node
+{
+    enum Type
+    {
+        kEmpty,
+        kByte,
+        kAnyByte,
+        kClass,
+        kBegin,
+        kEnd,
+        kWordBoundary,
+        kNotWordBoundary,
+        kConcat,
+        kAlternate,
+        kRepeat,
+        kGroup
+    };
+
+    explicit Node(Type nodeType)
+    : type(nodeType)
+    , value(0)
+    , minimum(0)
+    , maximum(0)
+    , greedy(true)
+    {}
+
+    Type type;
+    // Byte, class index or group index
+    int value;
+    int minimum;
+    // -1 for no limit
+    int maximum;
+    bool greedy;
+    std::vector< std::unique_ptr<Node> > children;
+};
+
+class HTRegex::Parser
+{
+public:
+    Parser(HTRegex* regex, const std::string& pattern, bool caseInsensitive)
+    : _regex(regex)
+    , _pattern(pattern)
+    , _position(0)
+    , _depth(0)
+    , _caseInsensitive(caseInsensitive)
+    , _failed(false)
+    {}
+
+    // Return nullptr if the pattern is invalid
+    std::unique_ptr<Node> parse()
+    {
+        std::unique_ptr<Node> node = parseAlternation();
+        if(_failed || _position != _pattern.size())
+        {
+            return nullptr;
+        }
+        return node;
+    }
+
+private:
+    bool atEnd() const
+    {
+        return _position >= _pattern.size();
+    }
+
+    char peek() const
+    {
+        return _pattern[_position];
+    }
+
+    std::unique_ptr<Node> fail()
+    {
+        _failed = true;
+        return nullptr;
+    }
+
+    std::unique_ptr<Node> parseAlternation()
+    {
+        if(++_depth > kMaxNestingDepth)
+        {
+            return fail();
+        }
+
+        std::unique_ptr<Node> node = parseConcatenation();
+        if(!_failed && !atEnd() && peek() == '|')
+        {
+            std::unique_ptr<Node> alternate(new Node(Node::kAlternate));
+            alternate->children.push_back(std::move(node));
+            while(!_failed && !atEnd() && peek() == '|')
+            {
+                ++_position;
+                alternate->children.push_back(parseConcatenation());
+            }
+            node = std::move(alternate);
+        }
+
+        --_depth;
+        if(_failed)
+        {
+            return nullptr;
+        }
+        return node;
+    }
+
+    std::unique_ptr<Node> parseConcatenation()
+    {
+        std::unique_ptr<Node> concat(new Node(Node::kConcat));
+        while(!_failed && !atEnd() && peek() != '|' && peek() != ')')
+        {
+            concat->children.push_back(parseRepetition());
+        }
+        return concat;
+    }
+
+    std::unique_ptr<Node> parseRepetition()
+    {
+        std::unique_ptr<Node> atom = parseAtom();
+        if(_failed)
+        {
+            return nullptr;
+        }
+
+        bool repeated = false;
+        while(!atEnd())
+        {
+            int minimum = 0;
+            int maximum = 0;
+            char c = peek();
+            if(c == '*' || c == '+' || c == '?')
+            {
+                minimum = c == '+' ? 1 : 0;
+                maximum = c == '?' ? 1 : -1;
+                ++_position;
+            }
+            else if(c != '{' || !parseBraces(minimum, maximum))
+            {
+                break;
+            }
+
+            // Quantifying a quantifier, as in a**, repeats nothing
+            if(repeated || minimum > kMaxRepeatCount || maximum > kMaxRepeatCount || (maximum >= 0 && maximum < minimum))
+            {
+                return fail();
+            }
+            repeated = true;
+
+            std::unique_ptr<Node> repeat(new Node(Node::kRepeat));
+            repeat->minimum = minimum;
+            repeat->maximum = maximum;
+            if(!atEnd() && peek() == '?')
+            {
+                repeat->greedy = false;
+                ++_position;
+            }
+            repeat->children.push_back(std::move(atom));
+            atom = std::move(repeat);
+        }
+        return atom;
+    }
+
+    // Parse {n}, {n,} or {n,m}. Anything else leaves the position alone, { is then a literal
+    bool parseBraces(int& minimum, int& maximum)
+    {
+        size_t start = _position;
+        ++_position;
+        if(!parseNumber(minimum))
+        {
+            _position = start;
+            return false;
+        }
+
+        maximum = minimum;
+        if(!atEnd() && peek() == ',')
+        {
+            ++_position;
+            if(!parseNumber(maximum))
+            {
+                maximum = -1;
+            }
+        }
+
+        if(atEnd() || peek() != '}')
+        {
+            _position = start;
+            return false;
+        }
+        ++_position;
+        return true;
+    }
+
+    bool parseNumber(int& number)
+    {
+        size_t start = _position;
+        number = 0;
+        while(!atEnd() && peek() >= '0' && peek() <= '9')
+        {
+            // Anything over the limit fails later, stop growing before overflow
+            number = std::min(number * 10 + (peek() - '0'), kMaxRepeatCount + 1);
+            ++_position;
+        }
+        return _position > start;
+    }
+
+    std::unique_ptr<Node> parseAtom()
+    {
+        char c = peek();
+        ++_position;
+        switch(c)
+        {
+            case '(':
+                return parseGroup();
+            case '[':
+                return parseClass();
+            case '.':
+                return std::unique_ptr<Node>(new Node(Node::kAnyByte));
+            case '^':
+                return std::unique_ptr<Node>(new Node(Node::kBegin));
+            case '$':
+                return std::unique_ptr<Node>(new Node(Node::kEnd));
+            case '*':
+            case '+':
+            case '?':
+                return fail();
+            case '\\':
+                return parseEscape();
+            default:
+                return literal(static_cast<unsigned char>(c));
+        }
+    }
+
+    std::unique_ptr<Node> parseGroup()
+    {
+        int group = -1;
+        if(_pattern.compare(_position, 2, "?:") == 0)
+        {
+            _position += 2;
+        }
+        else if(!atEnd() && peek() == '?')
+        {
+            // Lookaround needs backtracking
+            return fail();
+        }
+        else
+        {
+            group = static_cast<int>(++_regex->_captureCount);
+        }
+
+        std::unique_ptr<Node> inner = parseAlternation();
+        if(_failed || atEnd() || peek() != ')')
+        {
+            return fail();
+        }
+        ++_position;
+
+        if(group < 0)
+        {
+            return inner;
+        }
+        std::unique_ptr<Node> node(new Node(Node::kGroup));
+        node->value = group;
+        node->children.push_back(std::move(inner));
+        return node;
+    }
+
+    std::unique_ptr<Node> parseEscape()
+    {
+        if(atEnd())
+        {
+            return fail();
+        }
+
+        char c = peek();
+        ++_position;
+        switch(c)
+        {
+            case 'd':
+            case 'w':
+            case 's':
+                return classNode(escapeSet(c), false);
+            case 'D':
+            case 'W':
+            case 'S':
+                return classNode(escapeSet(c - 'A' + 'a'), true);
+            case 'b':
+                return std::unique_ptr<Node>(new Node(Node::kWordBoundary));
+            case 'B':
+                return std::unique_ptr<Node>(new Node(Node::kNotWordBoundary));
+            default:
+                break;
+        }
+
+        int byte = escapeByte(c, false);
+        if(byte < 0)
+        {
+            return fail();
+        }
+        return literal(static_cast<unsigned char>(byte));
+    }
+
+    // Byte of a single character escape, -1 if it is not one
+    int escapeByte(char c, bool inClass)
+    {
+        switch(c)
+        {
+            case 'n':
+                return '\n';
+            case 'r':
+                return '\r';
+            case 't':
+                return '\t';
+            case 'f':
+                return '\f';
+            case 'v':
+                return '\v';
+            case '0':
+                return '\0';
+            case 'b':
+                // Backspace inside a class, a word boundary outside
+                return inClass ? '\b' : -1;
+            case 'x':
+            {
+                if(_position + 2 > _pattern.size())
+                {
+                    return -1;
+                }
+                int high = hexValue(_pattern[_position]);
+                int low = hexValue(_pattern[_position + 1]);
+                if(high < 0 || low < 0)
+                {
+                    return -1;
+                }
+                _position += 2;
+                return high * 16 + low;
+            }
+            default:
+                break;
+        }
+
+        // Backreferences need backtracking
+        if(c >= '1' && c <= '9')
+        {
+            return -1;
+        }
+        return static_cast<unsigned char>(c);
+    }
+
+    std::unique_ptr<Node> parseClass()
+    {
+        bool negated = false;
+        if(!atEnd() && peek() == '^')
+        {
+            negated = true;
+            ++_position;
+        }
+
+        std::bitset<256> set;
+        while(true)
+        {
+            if(atEnd())
+            {
+                return fail();
+            }
+            char c = peek();
+            ++_position;
+            if(c == ']')
+            {
+                break;
+            }
+
+            int low = static_cast<unsigned char>(c);
+            if(c == '\\')
+            {
+                if(atEnd())
+                {
+                    return fail();
+                }
+                char escape = peek();
+                ++_position;
+                if(strchr("dwsDWS", escape) != nullptr)
+                {
+                    bool upper = escape >= 'A' && escape <= 'Z';
+                    std::bitset<256> escaped = escapeSet(upper ? escape - 'A' + 'a' : escape);
+                    set |= upper ? ~escaped : escaped;
+                    continue;
+                }
+                low = escapeByte(escape, true);
+                if(low < 0)
+                {
+                    return fail();
+                }
+            }
+
+            // A - before ] or at the start is a literal
+            if(_position + 1 < _pattern.size() && peek() == '-' && _pattern[_position + 1] != ']')
+            {
+                ++_position;
+                char end = peek();
+                ++_position;
+                int high = static_cast<unsigned char>(end);
+                if(end == '\\')
+                {
+                    if(atEnd())
+                    {
+                        return fail();
+                    }
+                    char escape = peek();
+                    ++_position;
+                    high = strchr("dwsDWS", escape) != nullptr ? -1 : escapeByte(escape, true);
+                }
+                if(high < low)
+                {
+                    return fail();
+                }
+                for(int value = low; value <= high; ++value)
+                {
+                    set.set(value);
+                }
+            }
+            else
+            {
+                set.set(low);
+            }
+        }
+        return classNode(set, negated);
+    }
+
+    std::unique_ptr<Node> literal(unsigned char byte)
+    {
+        if(_caseInsensitive && isalpha(byte))
+        {
+            std::bitset<256> set;
+            set.set(byte);
+            return classNode(set, false);
+        }
+        std::unique_ptr<Node> node(new Node(Node::kByte));
+        node->value = byte;
+        return node;
+    }
+
+    // Case folding happens before negation, so [^a] with kCaseInsensitive excludes A as well
+    std::unique_ptr<Node> classNode(std::bitset<256> set, bool negated)
+    {
+        if(_caseInsensitive)
+        {
+            for(int c = 'a'; c <= 'z'; ++c)
+            {
+                if(set[c] || set[c - 'a' + 'A'])
+                {
+                    set.set(c);
+                    set.set(c - 'a' + 'A');
+                }
+            }
+        }
+        if(negated)
+        {
+            set.flip();
+        }
+
+        std::unique_ptr<Node> node(new Node(Node::kClass));
+        node->value = static_cast<int>(_regex->_classes.size());
+        _regex->_classes.push_back(set);
+        return node;
+    }
+
+    HTRegex* _regex;
+    const std::string& _pattern;
+    size_t _position;
+    size_t _depth;
+    bool _caseInsensitive;
+    bool _failed;
+};
+
+//--------------------------------------------------------------------
+//
+// Pike VM
+//
+//--------------------------------------------------------------------
+
+class HTRegex::Matcher
+{
+public:
+    Matcher(const HTRegex* regex, const char* text, size_t length)
+    : _regex(regex)
+    , _program(regex->_program)
+    , _classes(regex->_classes)
+    , _text(text)
+    , _length(length)
+    , _slotCount(2 * (regex->_captureCount + 1))
+    , _generation(0)
+    {
+        _current.marks.assign(_program.size(), 0);
+        _next.marks.assign(_program.size(), 0);
+    }
+
+    // Leftmost first match at or after start, threads are kept in priority order and the
+    // first thread to reach Match cuts off every thread behind it
+    bool run(size_t start, bool wholeString, std::vector<size_t>& result)
+    {
+        std::vector<size_t> slots(_slotCount, kNoPosition);
+        bool matched = false;
+        clear(_current);
+
+        for(size_t position = start; ; ++position)
+        {
+            if(!matched && (position == start || !wholeString))
+            {
+                if(_current.pcs.empty() && _regex->_hasFirstBytes && !wholeString)
+                {
+                    position = nextCandidate(position);
+                    if(position >= _length)
+                    {
+                        break;
+                    }
+                }
+                std::fill(slots.begin(), slots.end(), kNoPosition);
+                addThread(_current, 0, position, slots);
+            }
+            if(_current.pcs.empty() && (matched || wholeString || position >= _length))
+            {
+                break;
+            }
+
+            clear(_next);
+            unsigned char byte = position < _length ? static_cast<unsigned char>(_text[position]) : 0;
+            for(size_t i = 0; i < _current.pcs.size(); ++i)
+            {
+                int pc = _current.pcs[i];
+                const Instruction& instruction = _program[pc];
+                const size_t* threadSlots = &_current.slots[i * _slotCount];
+
+                bool advance = false;
+                switch(instruction.opcode)
+                {
+                    case kMatch:
+                        if(wholeString && position != _length)
+                        {
+                            break;
+                        }
+                        result.assign(threadSlots, threadSlots + _slotCount);
+                        matched = true;
+                        i = _current.pcs.size();
+                        break;
+                    case kByte:
+                        advance = position < _length && byte == instruction.x;
+                        break;
+                    case kAnyByte:
+                        advance = position < _length && byte != '\n';
+                        break;
+                    case kClass:
+                        advance = position < _length && _classes[instruction.x][byte];
+                        break;
+                    default:
+                        break;
+                }
+
+                if(advance)
+                {
+                    std::copy(threadSlots, threadSlots + _slotCount, slots.begin());
+                    addThread(_next, pc + 1, position + 1, slots);
+                }
+            }
+
+            std::swap(_current, _next);
+            if(position >= _length)
+            {
+                break;
+            }
+        }
+        return matched;
+    }
+
+private:
+    struct ThreadList
+    {
+        std::vector<int> pcs;
+        // _slotCount capture slots per thread
+        std::vector<size_t> slots;
+        // Instructions already added for the current generation
+        std::vector<size_t> marks;
+        size_t generation;
+    };
+
+    // Negative pc restores slot to value once the threads after a Save are added
+    struct Step
+    {
+        int pc;
+        int slot;
+        size_t value;
+    };
+
+    // First position at or after position holding a possible first byte, _length if none
+    size_t nextCandidate(size_t position) const
+    {
+        if(_regex->_firstByte >= 0)
+        {
+            const void* found = memchr(_text + position, _regex->_firstByte, _length - position);
+            return found != nullptr ? static_cast<const char*>(found) - _text : _length;
+        }
+        while(position < _length && !_regex->_firstBytes[static_cast<unsigned char>(_text[position])])
+        {
+            ++position;
+        }
+        return position;
+    }
+
+    void clear(ThreadList& list)
+    {
+        list.pcs.clear();
+        list.slots.clear();
+        list.generation = ++_generation;
+    }
+
+    // Follow jumps, splits, saves and assertions from pc and add the threads that wait for a
+    // byte or a match. An explicit stack keeps deep programs off the call stack
+    void addThread(ThreadList& list, int startPc, size_t position, std::vector<size_t>& slots)
+    {
+        _stack.clear();
+        Step first = { startPc, 0, 0 };
+        _stack.push_back(first);
+        while(!_stack.empty())
+        {
+            Step step = _stack.back();
+            _stack.pop_back();
+            if(step.pc < 0)
+            {
+                slots[step.slot] = step.value;
+                continue;
+            }
+
+            int pc = step.pc;
+            if(list.marks[pc] == list.generation)
+            {
+                continue;
+            }
+            list.marks[pc] = list.generation;
+
+            const Instruction& instruction = _program[pc];
+            switch(instruction.opcode)
+            {
+                case kJump:
+                    push(instruction.x);
+                    break;
+                case kSplit:
+                    push(instruction.y);
+                    push(instruction.x);
+                    break;
+                case kSave:
+                {
+                    Step restore = { -1, instruction.x, slots[instruction.x] };
+                    _stack.push_back(restore);
+                    slots[instruction.x] = position;
+                    push(pc + 1);
+                    break;
+                }
+                case kBegin:
+                    if(position == 0)
+                    {
+                        push(pc + 1);
+                    }
+                    break;
+                case kEnd:
+                    if(position == _length)
+                    {
+                        push(pc + 1);
+                    }
+                    break;
+                case kWordBoundary:
+                case kNotWordBoundary:
+                {
+                    bool before = position > 0 && isWordByte(static_cast<unsigned char>(_text[position - 1]));
+                    bool after = position < _length && isWordByte(static_cast<unsigned char>(_text[position]));
+                    if((before != after) == (instruction.opcode == kWordBoundary))
+                    {
+                        push(pc + 1);
+                    }
+                    break;
+                }
+                default:
+                    list.pcs.push_back(pc);
+                    list.slots.insert(list.slots.end(), slots.begin(), slots.end());
+                    break;
+            }
+        }
+    }
+
+    void push(int pc)
+    {
+        Step step = { pc, 0, 0 };
+        _stack.push_back(step);
+    }
+
+    const HTRegex* _regex;
+    const std::vector<Instruction>& _program;
+    const std::vector< std::bitset<256> >& _classes;
+    const char* _text;
+    size_t _length;
+    size_t _slotCount;
+    size_t _generation;
+    ThreadList _current;
+    ThreadList _next;
+    std::vector<Step> _stack;
+};
+
+//--------------------------------------------------------------------
+//
+// HTRegex
+//
+//--------------------------------------------------------------------
+
+// Compiled patterns by options and pattern, shared by the whole process
+static HTCache* sharedCache()
+{
+    static HTCache* cache = []
+    {
+        HTCache* object = HTCache::createWithLimits(kCacheCountLimit, 0, 0);
+        object->retain();
+        return object;
+    }();
+    return cache;
+}
+
+HTRegex* HTRegex::create(const char* pattern)
+{
+    return createWithOptions(pattern, kNoOptions);
+}
+
+HTRegex* HTRegex::createWithOptions(const char* pattern, unsigned int options)
+{
+    if(pattern == nullptr)
+    {
+        return nullptr;
+    }
+
+    HTString* key = HTString::format("{}/{}", options, pattern);
+    HTRefPtr<HTRef> cached = sharedCache()->objectForKey(key);
+    if(cached != nullptr)
+    {
+        // The cache may evict it at any time, the caller gets its own autoreleased reference
+        HTRegex* regex = static_cast<HTRegex*>(cached.get());
+        regex->retain();
+        regex->autorelease();
+        return regex;
+    }
+
+    HTRegex* regex = new HTRegex();
+    if(regex && regex->initWithPattern(pattern, options))
+    {
+        regex->autorelease();
+        sharedCache()->setObject(regex, key);
+    }
+    else
+    {
+        HT_SAFE_DELETE(regex);
+    }
+    return regex;
+}
+
+HTRegex::HTRegex()
+: _captureCount(0)
+, _hasFirstBytes(false)
+, _firstByte(-1)
+{
+
+}
+
+HTRegex::~HTRegex()
+{
+
+}
+
+bool HTRegex::initWithPattern(const char* pattern, unsigned int options)
+{
+    if(pattern == nullptr)
+    {
+        return false;
+    }
+
+    _pattern = pattern;
+    _captureCount = 0;
+    _program.clear();
+    _classes.clear();
+    _hasFirstBytes = false;
+    _firstByte = -1;
+
+    Parser parser(this, _pattern, (options & kCaseInsensitive) != 0);
+    std::unique_ptr<Node> node = parser.parse();
+    if(node == nullptr)
+    {
+        return false;
+    }
+
+    // Slots 0 and 1 hold the whole match
+    emit(kSave, 0, 0);
+    if(!compile(node.get()))
+    {
+        return false;
+    }
+    emit(kSave, 1, 0);
+    emit(kMatch, 0, 0);
+    computeFirstBytes();
+    return true;
+}
+
+void HTRegex::computeFirstBytes()
+{
+    _firstBytes.reset();
+    _hasFirstBytes = false;
+    _firstByte = -1;
+
+    // Walk everything reachable without consuming a byte. Assertions are stepped over,
+    // which can only add bytes that never start a match
+    std::vector<bool> visited(_program.size(), false);
+    std::vector<int> pending(1, 0);
+    while(!pending.empty())
+    {
+        int pc = pending.back();
+        pending.pop_back();
+        if(visited[pc])
+        {
+            continue;
+        }
+        visited[pc] = true;
+
+        const Instruction& instruction = _program[pc];
+        switch(instruction.opcode)
+        {
+            case kByte:
+                _firstBytes.set(instruction.x);
+                break;
+            case kAnyByte:
+                _firstBytes.set();
+                _firstBytes.reset('\n');
+                break;
+            case kClass:
+                _firstBytes |= _classes[instruction.x];
+                break;
+            case kMatch:
+                // An empty match is possible anywhere
+                return;
+            case kJump:
+                pending.push_back(instruction.x);
+                break;
+            case kSplit:
+                pending.push_back(instruction.x);
+                pending.push_back(instruction.y);
+                break;
+            default:
+                pending.push_back(pc + 1);
+                break;
+        }
+    }
+
+    _hasFirstBytes = true;
+    if(_firstBytes.count() == 1)
+    {
+        for(int c = 0; c < 256; ++c)
+        {
+            if(_firstBytes[c])
+            {
+                _firstByte = c;
+                break;
+            }
+        }
+    }
+}
+
+int HTRegex::emit(Opcode opcode, int x, int y)
+{
+    Instruction instruction = { opcode, x, y };
+    _program.push_back(instruction);
+    return static_cast<int>(_program.size() - 1);
+}
+
+bool HTRegex::compile(const Node* node)
+{
+    if(_program.size() > kMaxProgramSize)
+    {
+        return false;
+    }
+
+    switch(node->type)
+    {
+        case Node::kEmpty:
+            break;
+        case Node::kByte:
+            emit(kByte, node->value, 0);
+            break;
+        case Node::kAnyByte:
+            emit(kAnyByte, 0, 0);
+            break;
+        case Node::kClass:
+            emit(kClass, node->value, 0);
+            break;
+        case Node::kBegin:
+            emit(kBegin, 0, 0);
+            break;
+        case Node::kEnd:
+            emit(kEnd, 0, 0);
+            break;
+        case Node::kWordBoundary:
+            emit(kWordBoundary, 0, 0);
+            break;
+        case Node::kNotWordBoundary:
+            emit(kNotWordBoundary, 0, 0);
+            break;
+        case Node::kConcat:
+            for(const auto& child: node->children)
+            {
+                if(!compile(child.get()))
+                {
+                    return false;
+                }
+            }
+            break;
+        case Node::kGroup:
+            emit(kSave, 2 * node->value, 0);
+            if(!compile(node->children[0].get()))
+            {
+                return false;
+            }
+            emit(kSave, 2 * node->value + 1, 0);
+            break;
+        case Node::kAlternate:
+        {
+            // Split to each alternative in turn, every one but the last jumps to the end
+            std::vector<int> jumps;
+            for(size_t i = 0; i < node->children.size(); ++i)
+            {
+                if(i + 1 == node->children.size())
+                {
+                    if(!compile(node->children[i].get()))
+                    {
+                        return false;
+                    }
+                    break;
+                }
+                int split = emit(kSplit, 0, 0);
+                _program[split].x = static_cast<int>(_program.size());
+                if(!compile(node->children[i].get()))
+                {
+                    return false;
+                }
+                jumps.push_back(emit(kJump, 0, 0));
+                _program[split].y = static_cast<int>(_program.size());
+            }
+            for(auto jump: jumps)
+            {
+                _program[jump].x = static_cast<int>(_program.size());
+            }
+            break;
+        }
+        case Node::kRepeat:
+        {
+            const Node* child = node->children[0].get();
+            for(int i = 0; i < node->minimum; ++i)
+            {
+                if(!compile(child))
+                {
+                    return false;
+                }
+            }
+
+            if(node->maximum < 0)
+            {
+                // loop: split body, out; body; jump loop; out:
+                int split = emit(kSplit, 0, 0);
+                if(!compile(child))
+                {
+                    return false;
+                }
+                emit(kJump, split, 0);
+                int body = split + 1;
+                int out = static_cast<int>(_program.size());
+                _program[split].x = node->greedy ? body : out;
+                _program[split].y = node->greedy ? out : body;
+                break;
+            }
+
+            // Each optional copy may skip all the copies after it
+            std::vector<int> splits;
+            for(int i = node->minimum; i < node->maximum; ++i)
+            {
+                splits.push_back(emit(kSplit, 0, 0));
+                if(!compile(child))
+                {
+                    return false;
+                }
+            }
+            int out = static_cast<int>(_program.size());
+            for(auto split: splits)
+            {
+                _program[split].x = node->greedy ? split + 1 : out;
+                _program[split].y = node->greedy ? out : split + 1;
+            }
+            break;
+        }
+    }
+    return _program.size() <= kMaxProgramSize;
+}
+
+bool HTRegex::run(const char* text, size_t length, size_t start, bool wholeString, std::vector<size_t>& slots) const
+{
+    if(start > length)
+    {
+        return false;
+    }
+    Matcher matcher(this, text, length);
+    return matcher.run(start, wholeString, slots);
+}
+
+static void capturesFromSlots(const std::vector<size_t>& slots, std::vector<HTRegexCapture>& captures)
+{
+    captures.resize(slots.size() / 2);
+    for(size_t i = 0; i < captures.size(); ++i)
+    {
+        size_t first = slots[2 * i];
+        size_t last = slots[2 * i + 1];
+        if(first == kNoPosition || last == kNoPosition)
+        {
+            captures[i].location = -1;
+            captures[i].length = 0;
+        }
+        else
+        {
+            captures[i].location = static_cast<ssize_t>(first);
+            captures[i].length = last - first;
+        }
+    }
+}
+
+bool HTRegex::matches(HTString* string) const
+{
+    std::vector<size_t> slots;
+    return run(string->getCString(), string->length(), 0, true, slots);
+}
+
+bool HTRegex::search(HTString* string) const
+{
+    std::vector<size_t> slots;
+    return run(string->getCString(), string->length(), 0, false, slots);
+}
+
+bool HTRegex::firstMatch(HTString* string, size_t start, std::vector<HTRegexCapture>& captures) const
+{
+    std::vector<size_t> slots;
+    if(!run(string->getCString(), string->length(), start, false, slots))
+    {
+        return false;
+    }
+    capturesFromSlots(slots, captures);
+    return true;
+}
+
+HTArray* HTRegex::capturedStrings(HTString* string) const
+{
+    std::vector<HTRegexCapture> captures;
+    if(!firstMatch(string, 0, captures))
+    {
+        return nullptr;
+    }
+
+    HTArray* array = HTArray::createWithCapacity(captures.size());
+    for(const auto& capture: captures)
+    {
+        if(capture.location < 0)
+        {
+            array->addObject(HTString::create(""));
+        }
+        else
+        {
+            array->addObject(HTString::create(std::string(string->getCString() + capture.location, capture.length)));
+        }
+    }
+    return array;
+}
+
+void HTRegex::enumerateMatches(HTString* string, const std::function<void(const std::vector<HTRegexCapture>& captures, bool* stop)>& callback) const
+{
+    const char* text = string->getCString();
+    size_t length = string->length();
+    Matcher matcher(this, text, length);
+    std::vector<size_t> slots;
+    std::vector<HTRegexCapture> captures;
+    bool stop = false;
+
+    size_t position = 0;
+    while(position <= length && !stop && matcher.run(position, false, slots))
+    {
+        capturesFromSlots(slots, captures);
+        callback(captures, &stop);
+
+        // After an empty match the next search starts one byte later
+        position = slots[1] > slots[0] ? slots[1] : slots[1] + 1;
+    }
+}
+
+HTString* HTRegex::replaceAll(HTString* string, const char* replacement) const
+{
+    const char* text = string->getCString();
+    std::string result;
+    size_t copied = 0;
+    enumerateMatches(string, [&](const std::vector<HTRegexCapture>& captures, bool* stop)
+    {
+        result.append(text + copied, captures[0].location - copied);
+        for(const char* p = replacement; *p != '\0'; ++p)
+        {
+            if(p[0] == '$' && p[1] == '$')
+            {
+                result.push_back('$');
+                ++p;
+            }
+            else if(p[0] == '$' && p[1] >= '0' && p[1] <= '9' && static_cast<size_t>(p[1] - '0') < captures.size())
+            {
+                const HTRegexCapture& capture = captures[p[1] - '0'];
+                if(capture.location >= 0)
+                {
+                    result.append(text + capture.location, capture.length);
+                }
+                ++p;
+            }
+            else
+            {
+                result.push_back(*p);
+            }
+        }
+        copied = captures[0].location + captures[0].length;
+    });
+    result.append(text + copied, string->length() - copied);
+    return HTString::create(result);
+}
+
+NS_HT_END(Huta)
@@ -21,16 +21,52 @@
 // THE SOFTWARE.
 
 #include <Core/HTSet.h>
+#include <Core/HTHash.h>
+
+#include <cstdint>
 
 NS_HT_BEGIN(Huta)
 
+static const size_t kMinCapacity = 8;
+
+static const unsigned int kHashBits = sizeof(size_t) * 8;
+
+// Slots are indexed by the high bits of the hash, so a table is ordered by hash apart
+// from collision clusters. Walking one table in slot order while probing another one
+// visits the other table front to back, set algebra runs as a merge of the two sorted
+// hash arrays without sorting anything. Hashes are mixed to keep that true for weak
+// hash() overrides.
+static inline size_t slotHash(const HTObject* object)
+{
+    return static_cast<size_t>(HTHash::mix(static_cast<uint64_t>(object->hash())));
+}
+
+static inline unsigned int log2OfPowerOfTwo(size_t value)
+{
+    unsigned int bits = 0;
+    while((static_cast<size_t>(1) << bits) < value)
+    {
+        ++bits;
+    }
+    return bits;
+}
+
 HTSet::HTSet() 
+: _count(0)
+, _shift(kHashBits)
 {
 
 }
 
 HTSet::HTSet(const HTSet& other)
+: _slots(other._slots)
+, _count(other._count)
+, _shift(other._shift)
 {
+    for(auto& slot: _slots)
+    {
+        HT_SAFE_RETAIN(slot.object);
+    }
 }
 
 HTSet::~HTSet()
@@ -48,49 +84,358 @@ HTSet* HTSet::create()
     return ret;
 }
 
+HTSet* HTSet::createWithCapacity(size_t capacity)
+{
+    HTSet* ret = HTSet::create();
+    if(ret)
+    {
+        ret->reserve(capacity);
+    }
+    return ret;
+}
+
+HTSet* HTSet::createWithArray(HTArray* array)
+{
+    HTSet* ret = HTSet::createWithCapacity(array->count());
+    if(ret)
+    {
+        ret->addObjectsFromArray(array);
+    }
+    return ret;
+}
+
 size_t HTSet::count() const
 {
-    return _set.size();
+    return _count;
 }
 
 void HTSet::addObject(HTObject* object)
 {
-    if(_set.count(object) == 0)
+    if(object == nullptr)
+    {
+        return;
+    }
+
+    reserve(_count + 1);
+    Slot slot = { slotHash(object), object };
+    if(insertSlot(slot))
+    {
+        object->retain();
+        ++_count;
+    }
+}
+
+void HTSet::addObjectsFromArray(HTArray* array)
+{
+    reserve(_count + array->count());
+    for(auto it = array->begin(); it != array->end(); ++it)
     {
-        _set.insert(object->retain());
+        addObject(dynamic_cast<HTObject*>(it->get()));
     }
 }
 
 void HTSet::removeObject(HTObject* object)
 {
-    if(_set.erase(object) > 0)
+    if(object == nullptr)
     {
-        object->release();
+        return;
+    }
+
+    ssize_t index = findSlot(slotHash(object), object);
+    if(index >= 0)
+    {
+        HTObject* stored = _slots[index].object;
+        eraseSlot(index);
+        stored->release();
     }
 }
 
 void HTSet::removeAllObjects()
 {
-    for(auto it = _set.begin(); it != _set.end(); it++)
+    std::vector<Slot> slots;
+    slots.swap(_slots);
+    _count = 0;
+    _shift = kHashBits;
+
+    for(auto& slot: slots)
     {
-        HTRef* obj = *it;
-        _set.erase(it);
-        obj->release();
+        HT_SAFE_RELEASE(slot.object);
     }
 }
 
-bool HTSet::containsObject(HTObject* object)
+bool HTSet::containsObject(HTObject* object) const
+{
+    return member(object) != nullptr;
+}
+
+HTObject* HTSet::member(HTObject* object) const
 {
-    return _set.find(object) != _set.end();
+    if(object == nullptr)
+    {
+        return nullptr;
+    }
+
+    ssize_t index = findSlot(slotHash(object), object);
+    return index >= 0 ? _slots[index].object : nullptr;
+}
+
+void HTSet::unionSet(HTSet* other)
+{
+    if(other == this)
+    {
+        return;
+    }
+
+    reserve(_count + other->_count);
+    for(auto& slot: other->_slots)
+    {
+        if(slot.object && insertSlot(slot))
+        {
+            slot.object->retain();
+            ++_count;
+        }
+    }
+}
+
+void HTSet::intersectSet(HTSet* other)
+{
+    if(other != this)
+    {
+        filterWithSet(other, true);
+    }
+}
+
+void HTSet::minusSet(HTSet* other)
+{
+    if(other == this)
+    {
+        removeAllObjects();
+    }
+    else
+    {
+        filterWithSet(other, false);
+    }
+}
+
+bool HTSet::isSubsetOfSet(HTSet* other) const
+{
+    if(other == this)
+    {
+        return true;
+    }
+    if(_count > other->_count)
+    {
+        return false;
+    }
+    for(auto& slot: _slots)
+    {
+        if(slot.object && other->findSlot(slot.hash, slot.object) < 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HTSet::intersectsSet(HTSet* other) const
+{
+    const HTSet* smaller = _count <= other->_count ? this : other;
+    const HTSet* larger = smaller == this ? other : this;
+    for(auto& slot: smaller->_slots)
+    {
+        if(slot.object && larger->findSlot(slot.hash, slot.object) >= 0)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 HTArray* HTSet::allObjects() const
 {
-    HTArray* array = HTArray::create();
-    for(auto it = _set.begin(); it != _set.end(); it++)
+    HTArray* array = HTArray::createWithCapacity(_count);
+    for(auto& slot: _slots)
     {
-        array->addObject(*it);
+        if(slot.object)
+        {
+            array->addObject(slot.object);
+        }
     }
     return array;
 }
-NS_HT_END(Huta)
\ No newline at end of file
+
+void HTSet::enumerateObjects(const std::function<void(HTRef* object, bool* stop)>& callback) const
+{
+    bool stop = false;
+    for(auto it = _slots.begin(); it != _slots.end() && !stop; ++it)
+    {
+        if(it->object)
+        {
+            callback(it->object, &stop);
+        }
+    }
+}
+
+size_t HTSet::homeOf(size_t hash) const
+{
+    return hash >> _shift;
+}
+
+ssize_t HTSet::findSlot(size_t hash, const HTObject* object) const
+{
+    if(_count == 0)
+    {
+        return -1;
+    }
+
+    size_t mask = _slots.size() - 1;
+    for(size_t index = homeOf(hash); ; index = (index + 1) & mask)
+    {
+        const Slot& slot = _slots[index];
+        if(slot.object == nullptr)
+        {
+            return -1;
+        }
+        if(slot.hash == hash && (slot.object == object || slot.object->isEqual(object)))
+        {
+            return index;
+        }
+    }
+}
+
+// Place a slot, the table must have room for it. Return false if an equal object is present
+bool HTSet::insertSlot(const Slot& slot)
+{
+    size_t mask = _slots.size() - 1;
+    for(size_t index = homeOf(slot.hash); ; index = (index + 1) & mask)
+    {
+        Slot& current = _slots[index];
+        if(current.object == nullptr)
+        {
+            current = slot;
+            return true;
+        }
+        if(current.hash == slot.hash && (current.object == slot.object || current.object->isEqual(slot.object)))
+        {
+            return false;
+        }
+    }
+}
+
+// Backward shift deletion, no tombstones are left behind
+void HTSet::eraseSlot(size_t index)
+{
+    size_t mask = _slots.size() - 1;
+    size_t hole = index;
+    for(size_t next = (hole + 1) & mask; _slots[next].object != nullptr; next = (next + 1) & mask)
+    {
+        size_t home = homeOf(_slots[next].hash);
+        if(((next - home) & mask) >= ((next - hole) & mask))
+        {
+            _slots[hole] = _slots[next];
+            hole = next;
+        }
+    }
+    _slots[hole].hash = 0;
+    _slots[hole].object = nullptr;
+    --_count;
+}
+
+void HTSet::rehash(size_t capacity)
+{
+    std::vector<Slot> old(capacity, Slot{ 0, nullptr });
+    old.swap(_slots);
+    _shift = kHashBits - log2OfPowerOfTwo(capacity);
+
+    size_t mask = capacity - 1;
+    for(auto& slot: old)
+    {
+        if(slot.object)
+        {
+            size_t index = homeOf(slot.hash);
+            while(_slots[index].object != nullptr)
+            {
+                index = (index + 1) & mask;
+            }
+            _slots[index] = slot;
+        }
+    }
+}
+
+// Keep the load factor at most 3/4
+void HTSet::reserve(size_t count)
+{
+    if(!_slots.empty() && count * 4 <= _slots.size() * 3)
+    {
+        return;
+    }
+
+    size_t capacity = kMinCapacity;
+    while(count * 4 > capacity * 3)
+    {
+        capacity <<= 1;
+    }
+    if(capacity > _slots.size())
+    {
+        rehash(capacity);
+    }
+}
+
+// Keep the objects which are (or are not) present in other set
+void HTSet::filterWithSet(HTSet* other, bool keepMembers)
+{
+    std::vector<Slot> kept;
+    std::vector<HTObject*> dropped;
+    kept.reserve(_count);
+
+    for(auto& slot: _slots)
+    {
+        if(slot.object == nullptr)
+        {
+            continue;
+        }
+        if((other->findSlot(slot.hash, slot.object) >= 0) == keepMembers)
+        {
+            kept.push_back(slot);
+        }
+        else
+        {
+            dropped.push_back(slot.object);
+        }
+    }
+
+    if(dropped.empty())
+    {
+        return;
+    }
+
+    _slots.clear();
+    _count = 0;
+    reserve(kept.size());
+    for(auto& slot: kept)
+    {
+        insertSlot(slot);
+    }
+    _count = kept.size();
+
+    for(auto object: dropped)
+    {
+        object->release();
+    }
+}
+
+HTDescriptionKind HTSet::getDescriptionKind() const
+{
+    return kHTDescriptionSet;
+}
+
+void HTSet::getDescriptionElements(std::vector<HTRef*>& elements) const
+{
+    elements.reserve(elements.size() + count());
+    for(HTRef* object: *this)
+    {
+        elements.push_back(object);
+    }
+}
+
+NS_HT_END(Huta)
@@ -0,0 +1,361 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTSortedArray.h>
+#include <Core/HTArray.h>
+#include <Core/HTException.h>
+
+#include <algorithm>
+#include <utility>
+
+NS_HT_BEGIN(Huta)
+
+// Below this size the sorted array fits in a few cache lines and the plain search wins
+static const size_t kEytzingerMinimumCount = 256;
+
+HTSortedArray* HTSortedArray::createWithComparator(const Comparator& comparator)
+{
+    HTSortedArray* object = new HTSortedArray();
+    if(object && object->initWithComparator(comparator))
+    {
+        object->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(object);
+    }
+    return object;
+}
+
+HTSortedArray* HTSortedArray::createWithArray(HTArray* array, const Comparator& comparator)
+{
+    HTSortedArray* object = new HTSortedArray();
+    if(object && object->initWithArray(array, comparator))
+    {
+        object->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(object);
+    }
+    return object;
+}
+
+HTSortedArray::HTSortedArray()
+: _usesEytzingerLayout(false)
+{
+
+}
+
+HTSortedArray::~HTSortedArray()
+{
+
+}
+
+bool HTSortedArray::initWithComparator(const Comparator& comparator)
+{
+    if(!comparator)
+    {
+        return false;
+    }
+    _comparator = comparator;
+    removeAllObjects();
+    return true;
+}
+
+bool HTSortedArray::initWithArray(HTArray* array, const Comparator& comparator)
+{
+    if(!initWithComparator(comparator))
+    {
+        return false;
+    }
+
+    _data.assign(array->begin(), array->end());
+    std::stable_sort(_data.begin(), _data.end(), [this](const HTRefPtr<HTRef>& a, const HTRefPtr<HTRef>& b)
+    {
+        return _comparator(a.get(), b.get());
+    });
+    rebuildEytzinger();
+    return true;
+}
+
+HTRef* HTSortedArray::getObjectAtIndex(size_t index) const
+{
+    return _data[index].get();
+}
+
+size_t HTSortedArray::lowerBound(HTRef* object) const
+{
+    if(!_eytzinger.empty())
+    {
+        return searchEytzinger(object);
+    }
+    return searchSorted(object, 0, _data.size(), false);
+}
+
+size_t HTSortedArray::upperBound(HTRef* object) const
+{
+    return searchSorted(object, 0, _data.size(), true);
+}
+
+ssize_t HTSortedArray::indexOfObject(HTRef* object) const
+{
+    size_t index = lowerBound(object);
+    if(index < _data.size() && !_comparator(object, _data[index].get()))
+    {
+        return index;
+    }
+    return -1;
+}
+
+std::vector<ssize_t> HTSortedArray::indexesOfObjects(HTArray* objects) const
+{
+    size_t count = objects->count();
+    std::vector<ssize_t> indexes(count, -1);
+
+    std::vector<size_t> order(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this, objects](size_t a, size_t b)
+    {
+        return _comparator(objects->getObjectAtIndex(a), objects->getObjectAtIndex(b));
+    });
+
+    // Every element before position is ordered before the previous query, so gallop
+    // forward from there and finish with a binary search in the last step
+    size_t size = _data.size();
+    size_t position = 0;
+    for(auto query: order)
+    {
+        HTRef* object = objects->getObjectAtIndex(query);
+        size_t step = 1;
+        while(position + step - 1 < size && _comparator(_data[position + step - 1].get(), object))
+        {
+            position += step;
+            step *= 2;
+        }
+        size_t limit = std::min(position + step - 1, size);
+        position = searchSorted(object, position, limit - position, false);
+
+        if(position < size && !_comparator(object, _data[position].get()))
+        {
+            indexes[query] = position;
+        }
+    }
+    return indexes;
+}
+
+bool HTSortedArray::containsObject(HTRef* object) const
+{
+    return indexOfObject(object) >= 0;
+}
+
+size_t HTSortedArray::addObject(HTRef* object)
+{
+    size_t index = upperBound(object);
+    _data.insert(_data.begin() + index, object);
+    rebuildEytzinger();
+    return index;
+}
+
+void HTSortedArray::addObjectsFromSortedArray(HTArray* sorted)
+{
+    std::vector<HTRefPtr<HTRef>> objects(sorted->begin(), sorted->end());
+    for(size_t i = 1; i < objects.size(); ++i)
+    {
+        if(_comparator(objects[i].get(), objects[i - 1].get()))
+        {
+            throw HTException("Array is not sorted");
+        }
+    }
+    mergeSorted(objects);
+}
+
+void HTSortedArray::addObjectsFromArray(HTArray* array)
+{
+    std::vector<HTRefPtr<HTRef>> objects(array->begin(), array->end());
+    std::stable_sort(objects.begin(), objects.end(), [this](const HTRefPtr<HTRef>& a, const HTRefPtr<HTRef>& b)
+    {
+        return _comparator(a.get(), b.get());
+    });
+    mergeSorted(objects);
+}
+
+bool HTSortedArray::removeObject(HTRef* object)
+{
+    ssize_t index = indexOfObject(object);
+    if(index < 0)
+    {
+        return false;
+    }
+    removeObjectAtIndex(index);
+    return true;
+}
+
+void HTSortedArray::removeObjectAtIndex(size_t index)
+{
+    if(index >= _data.size())
+    {
+        throw HTException("Index out of range");
+    }
+    _data.erase(_data.begin() + index);
+    rebuildEytzinger();
+}
+
+void HTSortedArray::removeAllObjects()
+{
+    _data.clear();
+    rebuildEytzinger();
+}
+
+void HTSortedArray::setUsesEytzingerLayout(bool usesEytzingerLayout)
+{
+    _usesEytzingerLayout = usesEytzingerLayout;
+    rebuildEytzinger();
+}
+
+HTArray* HTSortedArray::allObjects() const
+{
+    HTArray* array = HTArray::createWithCapacity(_data.size());
+    for(const auto& object: _data)
+    {
+        array->addObject(object.get());
+    }
+    return array;
+}
+
+// Lower bound, or upper bound if upper is true, in [first, first + length). The range halves
+// on every step whatever the comparison says, so the loop count only depends on length and
+// the comparison result feeds an add instead of a branch
+size_t HTSortedArray::searchSorted(HTRef* object, size_t first, size_t length, bool upper) const
+{
+    size_t base = first;
+    while(length > 1)
+    {
+        size_t half = length / 2;
+        HTRef* probe = _data[base + half].get();
+        bool before = upper ? !_comparator(object, probe) : _comparator(probe, object);
+        base += before ? half : 0;
+        length -= half;
+    }
+    if(length == 1)
+    {
+        HTRef* probe = _data[base].get();
+        base += (upper ? !_comparator(object, probe) : _comparator(probe, object)) ? 1 : 0;
+    }
+    return base;
+}
+
+size_t HTSortedArray::searchEytzinger(HTRef* object) const
+{
+    size_t size = _eytzinger.size() - 1;
+    size_t node = 1;
+    while(node <= size)
+    {
+#if defined(__GNUC__)
+        // The 16 descendants four levels down are contiguous, fetch them ahead of time
+        if(node * 16 <= size)
+        {
+            __builtin_prefetch(&_eytzinger[node * 16]);
+        }
+#endif
+        node = 2 * node + (_comparator(_eytzinger[node], object) ? 1 : 0);
+    }
+
+    // Drop the right turns taken after the last left turn, that node is the lower bound
+    while(node & 1)
+    {
+        node >>= 1;
+    }
+    node >>= 1;
+    return node == 0 ? _data.size() : _eytzingerIndex[node];
+}
+
+// Merge from the back into the grown vector, so the existing elements move once and
+// an element equivalent to an existing one lands after it
+void HTSortedArray::mergeSorted(std::vector<HTRefPtr<HTRef>>& sorted)
+{
+    size_t existing = _data.size();
+    size_t added = sorted.size();
+    _data.resize(existing + added);
+
+    size_t target = existing + added;
+    while(added > 0)
+    {
+        if(existing > 0 && _comparator(sorted[added - 1].get(), _data[existing - 1].get()))
+        {
+            _data[--target] = std::move(_data[--existing]);
+        }
+        else
+        {
+            _data[--target] = std::move(sorted[--added]);
+        }
+    }
+    rebuildEytzinger();
+}
+
+void HTSortedArray::rebuildEytzinger()
+{
+    if(!_usesEytzingerLayout || _data.size() < kEytzingerMinimumCount)
+    {
+        std::vector<HTRef*>().swap(_eytzinger);
+        std::vector<size_t>().swap(_eytzingerIndex);
+        return;
+    }
+
+    _eytzinger.resize(_data.size() + 1);
+    _eytzingerIndex.resize(_data.size() + 1);
+    size_t next = 0;
+    placeEytzinger(next, 1);
+}
+
+// In order walk of the implicit tree, it hands out the sorted elements in order
+void HTSortedArray::placeEytzinger(size_t& next, size_t node)
+{
+    if(node >= _eytzinger.size())
+    {
+        return;
+    }
+    placeEytzinger(next, 2 * node);
+    _eytzinger[node] = _data[next].get();
+    _eytzingerIndex[node] = next;
+    ++next;
+    placeEytzinger(next, 2 * node + 1);
+}
+
+HTDescriptionKind HTSortedArray::getDescriptionKind() const
+{
+    return kHTDescriptionList;
+}
+
+void HTSortedArray::getDescriptionElements(std::vector<HTRef*>& elements) const
+{
+    elements.reserve(elements.size() + _data.size());
+    for(const auto& object: _data)
+    {
+        elements.push_back(object.get());
+    }
+}
+
+NS_HT_END(Huta)
@@ -21,40 +21,203 @@
 // THE SOFTWARE.
 
 #include <Core/HTString.h>
+#include <Core/HTOutputSink.h>
+#include <Core/HTStringSlice.h>
+#include <Core/HTStringSearch.h>
+#include <Core/HTUTF8.h>
+#include <Core/HTException.h>
+#include <Core/HTRegex.h>
 #include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <regex>
+#include <functional>
+#include <mutex>
+#include <vector>
 
 NS_HT_BEGIN(Huta)
 
-#define kMaxStringLen (1024*100)
+// Short results are formatted into this stack buffer, longer ones are formatted again
+// into a heap buffer of their exact length
+static const size_t kFormatBufferSize = 512;
 
-std::string stringWithFormat(const char* format, va_list ap)
+static void appendWithFormat(std::string& string, const char* format, va_list ap)
 {
-    char* p = new char[kMaxStringLen];
-    if(p != nullptr) 
+    char buffer[kFormatBufferSize];
+    va_list copy;
+    va_copy(copy, ap);
+    int length = vsnprintf(buffer, sizeof(buffer), format, copy);
+    va_end(copy);
+
+    if(length < 0)
     {
-        vsnprintf(p, kMaxStringLen, format, ap);
-        std::string string(p);
-        delete []p;
-        return string;
+        return;
+    }
+    if(static_cast<size_t>(length) < sizeof(buffer))
+    {
+        string.append(buffer, length);
+        return;
+    }
+
+    // Format into a separate buffer, an argument may point into string and growing string
+    // would free it while vsnprintf still reads it
+    std::vector<char> large(static_cast<size_t>(length) + 1);
+    vsnprintf(large.data(), large.size(), format, ap);
+    string.append(large.data(), length);
+}
+
+// Two digit strings for 00 to 99, integers are written two digits per division
+static const char kDigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static void appendUnsigned(std::string& string, uint64_t value, bool negative)
+{
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+    while(value >= 100)
+    {
+        unsigned int pair = static_cast<unsigned int>(value % 100) * 2;
+        value /= 100;
+        *--p = kDigitPairs[pair + 1];
+        *--p = kDigitPairs[pair];
+    }
+    if(value >= 10)
+    {
+        unsigned int pair = static_cast<unsigned int>(value) * 2;
+        *--p = kDigitPairs[pair + 1];
+        *--p = kDigitPairs[pair];
+    }
+    else
+    {
+        *--p = static_cast<char>('0' + value);
+    }
+    if(negative)
+    {
+        *--p = '-';
+    }
+    string.append(p, end - p);
+}
+
+// Shortest of 15 and 17 significant digits that reads back as the same double
+static void appendDouble(std::string& string, double value)
+{
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%.15g", value);
+    if(strtod(buffer, nullptr) != value && value == value)
+    {
+        length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+    }
+    string.append(buffer, length);
+}
+
+void HTFormatArgument::appendTo(std::string& string) const
+{
+    switch(_type)
+    {
+        case kNone:
+            break;
+        case kSigned:
+            // Negate in unsigned arithmetic so that the smallest int64 does not overflow
+            appendUnsigned(string, _signed < 0 ? 0 - static_cast<uint64_t>(_signed) : static_cast<uint64_t>(_signed), _signed < 0);
+            break;
+        case kUnsigned:
+            appendUnsigned(string, _unsigned, false);
+            break;
+        case kDouble:
+            appendDouble(string, _double);
+            break;
+        case kBool:
+            string.append(_signed ? "true" : "false");
+            break;
+        case kCharacter:
+            string.push_back(static_cast<char>(_signed));
+            break;
+        case kCharacters:
+            string.append(_view.data, _view.length);
+            break;
+        case kObject:
+        {
+            if(_object == nullptr)
+            {
+                string.append("(null)");
+                break;
+            }
+            const HTString* text = dynamic_cast<const HTString*>(_object);
+            if(text == nullptr)
+            {
+                // References that are not HTObject have no description, write the address
+                const HTObject* object = dynamic_cast<const HTObject*>(_object);
+                if(object == nullptr)
+                {
+                    char address[32];
+                    int length = snprintf(address, sizeof(address), "%p", static_cast<const void*>(_object));
+                    string.append(address, length > 0 ? length : 0);
+                    break;
+                }
+                text = object->toString();
+            }
+            string.append(text->getCString(), text->length());
+            break;
+        }
     }
-    return std::string("");
 }
 
+// _codePointCount before the count is known
+static const size_t kUnknownCount = static_cast<size_t>(-1);
+
 HTString::HTString() 
     :_string("")
+    ,_encodingState(0)
+    ,_codePointCount(kUnknownCount)
+    ,_hash(0)
+    ,_hasHash(false)
+    ,_interned(false)
 {}
 
 HTString::HTString(const char* str)
     :_string(str)
+    ,_encodingState(0)
+    ,_codePointCount(kUnknownCount)
+    ,_hash(0)
+    ,_hasHash(false)
+    ,_interned(false)
 {}
 
 HTString::HTString(const std::string& str)
     :_string(str)
+    ,_encodingState(0)
+    ,_codePointCount(kUnknownCount)
+    ,_hash(0)
+    ,_hasHash(false)
+    ,_interned(false)
+{}
+
+HTString::HTString(std::string&& str)
+    :_string(std::move(str))
+    ,_encodingState(0)
+    ,_codePointCount(kUnknownCount)
+    ,_hash(0)
+    ,_hasHash(false)
+    ,_interned(false)
 {}
 
 HTString::HTString(const HTString& str)
     :_string(str.getCString())
+    ,_encodingState(0)
+    ,_codePointCount(kUnknownCount)
+    ,_hash(0)
+    ,_hasHash(false)
+    ,_interned(false)
 {}
 
 HTString::~HTString()
@@ -66,7 +229,9 @@ HTString& HTString::operator=(const HTString& other)
 {
     if(this != &other)
     {
+        checkMutable();
         _string = other._string;
+        resetCachedState();
     }
 
     return *this;
@@ -74,33 +239,35 @@ HTString& HTString::operator=(const HTString& other)
 
 bool HTString::initWithFormat(const char* format, ...)
 {
-    bool ret;
+    checkMutable();
+    _string.clear();
     va_list ap;
     va_start(ap, format);
-    _string = stringWithFormat(format, ap);
+    appendWithFormat(_string, format, ap);
     va_end(ap);
+    resetCachedState();
 
-    return ret;
+    return true;
 }
 
 int HTString::intValue() const 
 {
-    return std::stoi(_string);
+    return HTNumberParser::parseLeading<int>(HTStringView(_string), "stoi");
 }
 
 unsigned int HTString::uintValue() const
 {
-    return (unsigned int) intValue();
+    return HTNumberParser::parseLeading<unsigned int>(HTStringView(_string), "stoul");
 }
 
 float HTString::floatValue() const
 {
-    return std::stof(_string);
+    return HTNumberParser::parseLeading<float>(HTStringView(_string), "stof");
 }
 
 double HTString::doubleValue() const 
 {
-    return std::stod(_string);
+    return HTNumberParser::parseLeading<double>(HTStringView(_string), "stod");
 }
 
 bool HTString::boolValue() const
@@ -110,7 +277,7 @@ bool HTString::boolValue() const
         return false;
     }
 
-    if(strcmp(_string.c_str(), "0") == 0 || strcmp(_string.c_str(), "false"))
+    if(strcmp(_string.c_str(), "0") == 0 || strcmp(_string.c_str(), "false") == 0)
     {
         return false;
     }
@@ -132,47 +299,280 @@ int HTString::compare(const char* str) const
     return strcmp(getCString(), str);
 }
 
+int HTString::compareIgnoringCase(const char* string) const
+{
+    return HTStringSearch::compareIgnoringCase(HTStringView(_string), HTStringView(string));
+}
+
+HTRange HTString::rangeOfString(const char* string, size_t start) const
+{
+    HTStringView needle(string);
+    ssize_t location = HTStringSearch::find(HTStringView(_string), needle, start);
+    return location < 0 ? HTRange() : HTRange(location, needle.length);
+}
+
+bool HTString::containsString(const char* string) const
+{
+    return HTStringSearch::find(HTStringView(_string), HTStringView(string)) >= 0;
+}
+
+bool HTString::hasPrefix(const char* prefix) const
+{
+    return HTStringSearch::hasPrefix(HTStringView(_string), HTStringView(prefix));
+}
+
+bool HTString::hasSuffix(const char* suffix) const
+{
+    return HTStringSearch::hasSuffix(HTStringView(_string), HTStringView(suffix));
+}
+
+size_t HTString::occurrencesOfString(const char* string) const
+{
+    return HTStringSearch::count(HTStringView(_string), HTStringView(string));
+}
+
 void HTString::append(const std::string& str)
 {
+    checkMutable();
     _string.append(str);
+    resetCachedState();
 }
 
 void HTString::appendFormat(const char* format, ...)
 {
+    checkMutable();
     va_list ap;
     va_start(ap, format);
-    char* p = new char[kMaxStringLen];
-
-    if(p != nullptr)
-    {
-        vsnprintf(p, kMaxStringLen, format, ap);
-        _string.append(p);
-        delete []p;
-    }
-
+    appendWithFormat(_string, format, ap);
     va_end(ap);
+    resetCachedState();
 }
 
 bool HTString::isEqual(const HTObject* object)
 {
+    if(object == this)
+    {
+        return true;
+    }
+
     bool ret = false;
     const HTString* pStr = dynamic_cast<const HTString*> (object);
     if(pStr != nullptr)
     {
-        if(_string.compare(pStr->_string) == 0)
+        // Interned strings have one instance per content, known hashes that differ rule out
+        // equality without reading the characters
+        bool differ = (_interned && pStr->_interned) ||
+                      (_hasHash.load(std::memory_order_acquire) && pStr->_hasHash.load(std::memory_order_acquire) &&
+                       _hash.load(std::memory_order_relaxed) != pStr->_hash.load(std::memory_order_relaxed));
+        if(!differ && _string.compare(pStr->_string) == 0)
         {
             ret = true;
         }
     }
+    else
+    {
+        // Slices compare by characters so both kinds can share one set or dictionary
+        const HTStringSlice* slice = dynamic_cast<const HTStringSlice*>(object);
+        ret = slice != nullptr && slice->getView() == HTStringView(_string);
+    }
     return ret;
 }
 
+size_t HTString::hash() const
+{
+    if(_hasHash.load(std::memory_order_acquire))
+    {
+        return _hash.load(std::memory_order_relaxed);
+    }
+
+    // Same hash as HTStringSlice and HTStringView
+    size_t value = HTStringView(_string).hash();
+    _hash.store(value, std::memory_order_relaxed);
+    _hasHash.store(true, std::memory_order_release);
+    return value;
+}
+
+// Table of interned strings. Lookups probe an open addressing array of atomic slots
+// without a lock, inserts take the mutex. Growing publishes a new array and keeps the old
+// one, since readers may still be probing it. The arrays kept add up to less than the
+// current one, and interned strings live as long as the process anyway
+class HTStringInternTable
+{
+public:
+    static HTStringInternTable& shared()
+    {
+        static HTStringInternTable* table = new HTStringInternTable();
+        return *table;
+    }
+
+    HTStringInternTable()
+    : _count(0)
+    {
+        _slots.store(createSlots(kInitialCapacity), std::memory_order_relaxed);
+    }
+
+    HTString* find(const HTStringView& characters, size_t hash) const
+    {
+        const Slots* slots = _slots.load(std::memory_order_acquire);
+        for(size_t i = hash & slots->mask; ; i = (i + 1) & slots->mask)
+        {
+            HTString* string = slots->entries[i].load(std::memory_order_acquire);
+            if(string == nullptr)
+            {
+                return nullptr;
+            }
+            if(string->_hash.load(std::memory_order_relaxed) == hash && HTStringView(string->_string) == characters)
+            {
+                return string;
+            }
+        }
+    }
+
+    HTString* intern(const HTStringView& characters)
+    {
+        size_t hash = characters.hash();
+        HTString* string = find(characters, hash);
+        if(string != nullptr)
+        {
+            return string;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        string = find(characters, hash);
+        if(string != nullptr)
+        {
+            return string;
+        }
+
+        // At most half full, so every probe ends at an empty slot
+        Slots* slots = _slots.load(std::memory_order_relaxed);
+        if((_count + 1) * 2 > slots->mask + 1)
+        {
+            Slots* larger = createSlots((slots->mask + 1) * 2);
+            larger->previous = slots;
+            for(size_t i = 0; i <= slots->mask; ++i)
+            {
+                HTString* entry = slots->entries[i].load(std::memory_order_relaxed);
+                if(entry != nullptr)
+                {
+                    insert(larger, entry, entry->_hash.load(std::memory_order_relaxed));
+                }
+            }
+            _slots.store(larger, std::memory_order_release);
+            slots = larger;
+        }
+
+        string = HTString::createInternedInstance(characters, hash);
+        insert(slots, string, hash);
+        ++_count;
+        return string;
+    }
+
+private:
+    static const size_t kInitialCapacity = 1024;
+
+    struct Slots
+    {
+        size_t mask;
+        std::atomic<HTString*>* entries;
+        // The array this one replaced
+        Slots* previous;
+    };
+
+    static Slots* createSlots(size_t capacity)
+    {
+        Slots* slots = new Slots();
+        slots->mask = capacity - 1;
+        slots->previous = nullptr;
+        slots->entries = new std::atomic<HTString*>[capacity]();
+        return slots;
+    }
+
+    static void insert(Slots* slots, HTString* string, size_t hash)
+    {
+        size_t i = hash & slots->mask;
+        while(slots->entries[i].load(std::memory_order_relaxed) != nullptr)
+        {
+            i = (i + 1) & slots->mask;
+        }
+        slots->entries[i].store(string, std::memory_order_release);
+    }
+
+    std::atomic<Slots*> _slots;
+    std::mutex _mutex;
+    size_t _count;
+};
+
+HTString* HTString::createInternedInstance(const HTStringView& characters, size_t hash)
+{
+    HTString* string = new HTString(characters.toStdString());
+    string->_hash.store(hash, std::memory_order_relaxed);
+    string->_hasHash.store(true, std::memory_order_relaxed);
+    string->_interned = true;
+    string->makeImmortal();
+    return string;
+}
+
+HTString* HTString::intern() const
+{
+    if(_interned)
+    {
+        return const_cast<HTString*>(this);
+    }
+    return HTStringInternTable::shared().intern(HTStringView(_string));
+}
+
+HTString* HTString::createInterned(const HTStringView& characters)
+{
+    return HTStringInternTable::shared().intern(characters);
+}
+
+// Return true if delimiter has no ECMAScript special character, it then matches itself only
+static bool isLiteralPattern(const char* delimiter)
+{
+    return delimiter[0] != '\0' && delimiter[strcspn(delimiter, "^$\\.*+?()[]{}|")] == '\0';
+}
+
 HTArray* HTString::componentsSeparatedByString(const char* delimiter)
 {
     HTArray* array = HTArray::create();
-    std::regex regex(delimiter);
+    if(isLiteralPattern(delimiter))
+    {
+        HTStringSplitter splitter = splitterWithDelimiter(delimiter);
+        HTStringView component;
+        while(splitter.next(component))
+        {
+            array->addObject(HTString::create(component.toStdString()));
+        }
+        return array;
+    }
+
+    // The compiled pattern comes from the HTRegex cache and never backtracks. Components
+    // follow std::sregex_token_iterator: the text before each match, then the rest after
+    // the last match unless it is empty, or the whole string if nothing matches
+    HTRegex* regex = HTRegex::create(delimiter);
+    if(regex != nullptr)
+    {
+        size_t copied = 0;
+        bool matched = false;
+        regex->enumerateMatches(this, [&](const std::vector<HTRegexCapture>& captures, bool* stop)
+        {
+            array->addObject(HTString::create(_string.substr(copied, captures[0].location - copied)));
+            copied = captures[0].location + captures[0].length;
+            matched = true;
+        });
+        if(!matched || copied < _string.size())
+        {
+            array->addObject(HTString::create(_string.substr(copied)));
+        }
+        return array;
+    }
+
+    // Backreferences and lookaround are left to std::regex, which also throws
+    // std::regex_error for an invalid pattern
+    std::regex fallback(delimiter);
     std::sregex_token_iterator 
-        first{std::begin(_string), std::end(_string), regex, -1}, last;
+        first{std::begin(_string), std::end(_string), fallback, -1}, last;
     for(auto it = first; it != last; it++)
     {
         array->addObject(HTString::create(*it));
@@ -180,6 +580,28 @@ HTArray* HTString::componentsSeparatedByString(const char* delimiter)
     return array;
 }
 
+HTStringSplitter HTString::splitterWithDelimiter(const char* delimiter) const
+{
+    return HTStringSplitter(HTStringView(_string), HTStringView(delimiter));
+}
+
+HTStringSlice* HTString::sliceWithRange(size_t offset, size_t length)
+{
+    return HTStringSlice::createWithRange(this, offset, length);
+}
+
+HTArray* HTString::slicesSeparatedByString(const char* delimiter)
+{
+    HTArray* array = HTArray::create();
+    HTStringSplitter splitter = splitterWithDelimiter(delimiter);
+    HTStringView component;
+    while(splitter.next(component))
+    {
+        array->addObject(HTStringSlice::createWithRange(this, component.data - _string.data(), component.length));
+    }
+    return array;
+}
+
 HTString* HTString::create(const std::string& str)
 {
     HTString* object = new HTString(str);
@@ -194,38 +616,223 @@ HTString* HTString::create(const std::string& str)
     return object;
 }
 
-HTString* HTString::createWithData(const unsigned char* data, size_t len)
+HTString* HTString::create(std::string&& str)
+{
+    HTString* object = new HTString(std::move(str));
+    if(object)
+    {
+        object->autorelease();
+    }
+    else
+    {
+        delete object;
+    }
+    return object;
+}
+
+HTString* HTString::createWithData(const unsigned char* data, size_t len, bool validateUTF8)
 {
     HTString* string = nullptr;
+    if(validateUTF8 && data != nullptr && !HTUTF8::validate(reinterpret_cast<const char*>(data), len))
+    {
+        return nullptr;
+    }
     if(data != nullptr)
     {
-        char* p = new char[len + 1];
-        if(p != nullptr)
-        {
-            p[len] = '\0';
-            if(len > 0)
-            {
-                memcpy(p, data, len);
-            }
-            string = HTString::create(p);
-            delete []p;
-        }
+        // Copied once, straight into the string
+        string = HTString::create(std::string(reinterpret_cast<const char*>(data), len));
+    }
+    if(string != nullptr && validateUTF8)
+    {
+        string->_encodingState.store(kEncodingChecked | kEncodingValidUTF8, std::memory_order_relaxed);
     }
     return string;
 }
 
 HTString* HTString::createWithFormat(const char* format, ...)
 {
+    HTString* string = new HTString();
     va_list ap;
     va_start(ap, format);
-    HTString* string = HTString::create(stringWithFormat(format, ap));
+    appendWithFormat(string->_string, format, ap);
     va_end(ap);
+    string->autorelease();
     return string;
 }
 
+HTString* HTString::createWithArguments(const char* format, const HTFormatArgument* arguments, size_t count)
+{
+    HTString* string = new HTString();
+    try
+    {
+        string->appendArguments(format, arguments, count);
+    }
+    catch(...)
+    {
+        string->release();
+        throw;
+    }
+    string->autorelease();
+    return string;
+}
+
+void HTString::appendArguments(const char* format, const HTFormatArgument* arguments, size_t count)
+{
+    checkMutable();
+    size_t start = _string.size();
+    if(start == 0)
+    {
+        _string.reserve(strlen(format) + count * 16);
+    }
+
+    try
+    {
+        size_t next = 0;
+        const char* literal = format;
+        const char* p = format;
+        while(*p != '\0')
+        {
+            if(*p != '{' && *p != '}')
+            {
+                ++p;
+                continue;
+            }
+
+            _string.append(literal, p - literal);
+            if(p[0] == p[1])
+            {
+                // {{ or }}
+                _string.push_back(*p);
+            }
+            else if(p[0] == '{' && p[1] == '}')
+            {
+                if(next >= count)
+                {
+                    throw HTException("Format placeholder count does not match the argument count");
+                }
+                arguments[next++].appendTo(_string);
+            }
+            else
+            {
+                throw HTException("Malformed format string, write {{ and }} for braces");
+            }
+            p += 2;
+            literal = p;
+        }
+        _string.append(literal, p - literal);
+
+        if(next != count)
+        {
+            throw HTException("Format placeholder count does not match the argument count");
+        }
+        resetCachedState();
+    }
+    catch(...)
+    {
+        // A bad format leaves the string as it was
+        _string.resize(start);
+        throw;
+    }
+}
+
+void HTString::resetCachedState()
+{
+    _encodingState.store(0, std::memory_order_relaxed);
+    _codePointCount.store(kUnknownCount, std::memory_order_relaxed);
+    _hasHash.store(false, std::memory_order_relaxed);
+}
+
+void HTString::checkMutable() const
+{
+    if(_interned)
+    {
+        throw HTException("Interned strings are immutable");
+    }
+}
+
+unsigned int HTString::getEncodingState() const
+{
+    unsigned int state = _encodingState.load(std::memory_order_relaxed);
+    if(state == 0)
+    {
+        state = kEncodingChecked;
+        if(HTUTF8::isASCII(_string.data(), _string.size()))
+        {
+            state |= kEncodingValidUTF8 | kEncodingASCII;
+        }
+        else if(HTUTF8::validate(_string.data(), _string.size()))
+        {
+            state |= kEncodingValidUTF8;
+        }
+        _encodingState.store(state, std::memory_order_relaxed);
+    }
+    return state;
+}
+
+bool HTString::isValidUTF8() const
+{
+    return (getEncodingState() & kEncodingValidUTF8) != 0;
+}
+
+bool HTString::isASCII() const
+{
+    return (getEncodingState() & kEncodingASCII) != 0;
+}
+
+size_t HTString::codePointCount() const
+{
+    size_t count = _codePointCount.load(std::memory_order_relaxed);
+    if(count == kUnknownCount)
+    {
+        unsigned int state = _encodingState.load(std::memory_order_relaxed);
+        count = (state & kEncodingASCII) != 0 ? _string.size() : HTUTF8::countCodePoints(_string.data(), _string.size());
+        _codePointCount.store(count, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+bool HTString::getUTF16String(std::u16string& result) const
+{
+    return HTUTF8::toUTF16(_string.data(), _string.size(), result);
+}
+
+bool HTString::getUTF32String(std::u32string& result) const
+{
+    return HTUTF8::toUTF32(_string.data(), _string.size(), result);
+}
+
+HTString* HTString::createWithUTF16(const char16_t* data, size_t length)
+{
+    std::string string;
+    if(!HTUTF8::fromUTF16(data, length, string))
+    {
+        return nullptr;
+    }
+    HTString* object = create(std::move(string));
+    object->_encodingState.store(kEncodingChecked | kEncodingValidUTF8, std::memory_order_relaxed);
+    return object;
+}
+
+HTString* HTString::createWithUTF32(const char32_t* data, size_t length)
+{
+    std::string string;
+    if(!HTUTF8::fromUTF32(data, length, string))
+    {
+        return nullptr;
+    }
+    HTString* object = create(std::move(string));
+    object->_encodingState.store(kEncodingChecked | kEncodingValidUTF8, std::memory_order_relaxed);
+    return object;
+}
+
 HTString* HTString::clone() const
 {
     return HTString::create(_string);
 }
 
+void HTString::describeSelfTo(HTOutputSink& sink) const
+{
+    sink.append(_string.data(), _string.size());
+}
+
 NS_HT_END(Huta)
@@ -0,0 +1,275 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTStringArray.h>
+#include <Core/HTString.h>
+#include <Core/HTStringSlice.h>
+#include <Core/HTArray.h>
+#include <Core/HTException.h>
+#include <Core/HTOutputSink.h>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+NS_HT_BEGIN(Huta)
+
+HTStringArray* HTStringArray::create()
+{
+    return createWithCapacity(0, 0);
+}
+
+HTStringArray* HTStringArray::createWithCapacity(size_t count, size_t byteCount)
+{
+    HTStringArray* object = new HTStringArray();
+    if(object && object->initWithCapacity(count, byteCount))
+    {
+        object->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(object);
+    }
+    return object;
+}
+
+// Characters of an element of an HTArray. Anything else than a string or a slice would
+// leave a hole and shift the indexes of the strings after it, so it is an error
+static HTStringView viewOfElement(HTRef* object)
+{
+    HTString* string = dynamic_cast<HTString*>(object);
+    if(string != nullptr)
+    {
+        return HTStringView(string->getCString(), string->length());
+    }
+    HTStringSlice* slice = dynamic_cast<HTStringSlice*>(object);
+    if(slice != nullptr)
+    {
+        return slice->getView();
+    }
+    throw HTException("HTStringArray elements must be HTString or HTStringSlice");
+}
+
+HTStringArray* HTStringArray::createWithArray(HTArray* array)
+{
+    // Size the buffer up front so it is filled without moving
+    size_t byteCount = 0;
+    for(const auto& object: *array)
+    {
+        byteCount += viewOfElement(object.get()).length + 1;
+    }
+
+    HTStringArray* strings = createWithCapacity(array->count(), byteCount);
+    if(strings != nullptr)
+    {
+        for(const auto& object: *array)
+        {
+            HTStringView view = viewOfElement(object.get());
+            strings->addString(view.data, view.length);
+        }
+    }
+    return strings;
+}
+
+HTStringArray::HTStringArray()
+: _offsets(1, 0)
+{
+
+}
+
+HTStringArray::~HTStringArray()
+{
+
+}
+
+bool HTStringArray::initWithCapacity(size_t count, size_t byteCount)
+{
+    removeAllStrings();
+    _characters.reserve(byteCount);
+    _offsets.reserve(count + 1);
+    return true;
+}
+
+HTString* HTStringArray::stringAtIndex(size_t index) const
+{
+    return HTString::create(viewAtIndex(index).toStdString());
+}
+
+void HTStringArray::addString(const char* characters, size_t length)
+{
+    // The characters may be a string of this array, growing the buffer would move them
+    size_t base = _characters.size();
+    const char* begin = _characters.data();
+    bool inside = base > 0 && characters >= begin && characters < begin + base;
+    size_t offset = inside ? static_cast<size_t>(characters - begin) : 0;
+    _characters.resize(base + length + 1);
+    if(length > 0)
+    {
+        memcpy(&_characters[base], inside ? _characters.data() + offset : characters, length);
+    }
+    _characters[base + length] = '\0';
+    _offsets.push_back(_characters.size());
+}
+
+void HTStringArray::addString(const std::string& string)
+{
+    addString(string.data(), string.size());
+}
+
+void HTStringArray::addString(HTString* string)
+{
+    addString(string->getCString(), string->length());
+}
+
+void HTStringArray::addStringsFromArray(HTStringArray* other)
+{
+    // other may be this array, so copy by size and index instead of through iterators
+    // into the vector being grown
+    size_t base = _characters.size();
+    size_t otherCount = other->count();
+    size_t otherSize = other->_characters.size();
+    _characters.resize(base + otherSize);
+    if(otherSize > 0)
+    {
+        memcpy(&_characters[base], other->_characters.data(), otherSize);
+    }
+    _offsets.reserve(_offsets.size() + otherCount);
+    for(size_t i = 1; i <= otherCount; ++i)
+    {
+        _offsets.push_back(base + other->_offsets[i]);
+    }
+}
+
+ssize_t HTStringArray::indexOfString(const HTStringView& view) const
+{
+    size_t size = count();
+    for(size_t i = 0; i < size; ++i)
+    {
+        if(viewAtIndex(i) == view)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void HTStringArray::sort()
+{
+    std::vector<size_t> indexes(count());
+    for(size_t i = 0; i < indexes.size(); ++i)
+    {
+        indexes[i] = i;
+    }
+    std::stable_sort(indexes.begin(), indexes.end(), [this](size_t a, size_t b)
+    {
+        return viewAtIndex(a) < viewAtIndex(b);
+    });
+    keepIndexes(indexes);
+}
+
+void HTStringArray::removeDuplicates()
+{
+    std::vector<size_t> indexes;
+    indexes.reserve(count());
+    std::unordered_set<HTStringView, HTStringViewHasher> seen;
+    seen.reserve(count());
+    for(size_t i = 0; i < count(); ++i)
+    {
+        if(seen.insert(viewAtIndex(i)).second)
+        {
+            indexes.push_back(i);
+        }
+    }
+    if(indexes.size() != count())
+    {
+        keepIndexes(indexes);
+    }
+}
+
+void HTStringArray::removeAllStrings()
+{
+    _characters.clear();
+    _offsets.assign(1, 0);
+}
+
+void HTStringArray::enumerateStrings(const std::function<void(const HTStringView& view, size_t index, bool* stop)>& callback) const
+{
+    bool stop = false;
+    size_t size = count();
+    for(size_t i = 0; i < size && !stop; ++i)
+    {
+        callback(viewAtIndex(i), i, &stop);
+    }
+}
+
+HTArray* HTStringArray::toArray() const
+{
+    HTArray* array = HTArray::createWithCapacity(count());
+    for(size_t i = 0; i < count(); ++i)
+    {
+        array->addObject(stringAtIndex(i));
+    }
+    return array;
+}
+
+size_t HTStringArray::getByteSize() const
+{
+    return _characters.capacity() + _offsets.capacity() * sizeof(size_t);
+}
+
+void HTStringArray::keepIndexes(const std::vector<size_t>& indexes)
+{
+    size_t byteCount = 0;
+    for(auto index: indexes)
+    {
+        byteCount += _offsets[index + 1] - _offsets[index];
+    }
+
+    std::vector<char> characters;
+    std::vector<size_t> offsets;
+    characters.reserve(byteCount);
+    offsets.reserve(indexes.size() + 1);
+    offsets.push_back(0);
+    for(auto index: indexes)
+    {
+        characters.insert(characters.end(), _characters.begin() + _offsets[index], _characters.begin() + _offsets[index + 1]);
+        offsets.push_back(characters.size());
+    }
+    _characters.swap(characters);
+    _offsets.swap(offsets);
+}
+
+void HTStringArray::describeSelfTo(HTOutputSink& sink) const
+{
+    sink.appendCharacter('[');
+    for(size_t i = 0; i < count(); i++)
+    {
+        if(i > 0)
+        {
+            sink.append(", ", 2);
+        }
+        sink.append(viewAtIndex(i));
+    }
+    sink.appendCharacter(']');
+}
+
+NS_HT_END(Huta)
@@ -0,0 +1,262 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTStringBuilder.h>
+#include <Core/HTException.h>
+#include <Core/HTOutputSink.h>
+
+#include <algorithm>
+#include <stdarg.h>
+#include <stdio.h>
+
+NS_HT_BEGIN(Huta)
+
+// Chunk sizes double from the smallest to the largest one
+static const size_t kMinimumChunkSize = 256;
+static const size_t kMaximumChunkSize = 1 << 20;
+
+// Room for any number written by appendValue
+static const size_t kValueReserve = 32;
+
+// Short formatted results go through this stack buffer
+static const size_t kFormatBufferSize = 512;
+
+HTStringBuilder* HTStringBuilder::create()
+{
+    return createWithCapacity(0);
+}
+
+HTStringBuilder* HTStringBuilder::createWithCapacity(size_t byteCount)
+{
+    HTStringBuilder* object = new HTStringBuilder();
+    if(object && object->initWithCapacity(byteCount))
+    {
+        object->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(object);
+    }
+    return object;
+}
+
+HTStringBuilder::HTStringBuilder()
+: _length(0)
+{
+
+}
+
+HTStringBuilder::~HTStringBuilder()
+{
+
+}
+
+bool HTStringBuilder::initWithCapacity(size_t byteCount)
+{
+    _chunks.clear();
+    _length = 0;
+    addChunk(byteCount);
+    return true;
+}
+
+HTStringView HTStringBuilder::getChunkAtIndex(size_t index) const
+{
+    if(index >= _chunks.size())
+    {
+        throw HTException("Index out of range");
+    }
+    return HTStringView(_chunks[index]);
+}
+
+void HTStringBuilder::enumerateChunks(const std::function<void(const HTStringView& chunk, bool* stop)>& callback) const
+{
+    bool stop = false;
+    for(const auto& chunk: _chunks)
+    {
+        callback(HTStringView(chunk), &stop);
+        if(stop)
+        {
+            break;
+        }
+    }
+}
+
+void HTStringBuilder::addChunk(size_t byteCount)
+{
+    // Double the last chunk, but never ask for less than the caller needs
+    size_t size = kMinimumChunkSize;
+    if(!_chunks.empty())
+    {
+        size = std::min(std::max(_chunks.back().capacity() * 2, kMinimumChunkSize), kMaximumChunkSize);
+    }
+    _chunks.push_back(std::string());
+    _chunks.back().reserve(std::max(size, byteCount));
+}
+
+void HTStringBuilder::reserve(size_t byteCount)
+{
+    std::string& tail = _chunks.back();
+    if(tail.capacity() - tail.size() >= byteCount)
+    {
+        return;
+    }
+    if(tail.empty())
+    {
+        tail.reserve(byteCount);
+    }
+    else
+    {
+        addChunk(byteCount);
+    }
+}
+
+void HTStringBuilder::append(const char* characters, size_t length)
+{
+    _length += length;
+    while(length > 0)
+    {
+        std::string& tail = _chunks.back();
+        size_t space = tail.capacity() - tail.size();
+        if(space == 0)
+        {
+            addChunk(length);
+            continue;
+        }
+
+        size_t count = std::min(space, length);
+        tail.append(characters, count);
+        characters += count;
+        length -= count;
+    }
+}
+
+void HTStringBuilder::append(const char* string)
+{
+    append(string, strlen(string));
+}
+
+void HTStringBuilder::append(const HTStringView& view)
+{
+    append(view.data, view.length);
+}
+
+void HTStringBuilder::append(HTString* string)
+{
+    append(string->getCString(), string->length());
+}
+
+void HTStringBuilder::appendCharacter(char character)
+{
+    append(&character, 1);
+}
+
+void HTStringBuilder::appendValue(const HTFormatArgument& value)
+{
+    // Strings and objects can be of any length, they are copied in like any other
+    // characters so they fill the chunks and never move what was appended before
+    HTFormatArgument::Type type = value.getType();
+    if(type == HTFormatArgument::kCharacters || type == HTFormatArgument::kObject)
+    {
+        std::string text;
+        value.appendTo(text);
+        append(text.data(), text.size());
+        return;
+    }
+
+    // Numbers fit in the room reserved here and are written straight into the last chunk
+    reserve(kValueReserve);
+    std::string& tail = _chunks.back();
+    size_t size = tail.size();
+    value.appendTo(tail);
+    _length += tail.size() - size;
+}
+
+void HTStringBuilder::appendFormat(const char* format, ...)
+{
+    char buffer[kFormatBufferSize];
+    va_list ap;
+    va_start(ap, format);
+    va_list copy;
+    va_copy(copy, ap);
+    int length = vsnprintf(buffer, sizeof(buffer), format, copy);
+    va_end(copy);
+
+    if(length >= 0 && static_cast<size_t>(length) < sizeof(buffer))
+    {
+        append(buffer, length);
+    }
+    else if(length >= 0)
+    {
+        // Format again into a separate buffer, an argument may point into the last chunk
+        // and would be overwritten while vsnprintf reads it
+        std::vector<char> large(static_cast<size_t>(length) + 1);
+        vsnprintf(large.data(), large.size(), format, ap);
+        append(large.data(), length);
+    }
+    va_end(ap);
+}
+
+void HTStringBuilder::removeAllCharacters()
+{
+    _chunks.resize(1);
+    _chunks[0].clear();
+    _length = 0;
+}
+
+HTString* HTStringBuilder::toString() const
+{
+    std::string string;
+    string.reserve(_length);
+    for(const auto& chunk: _chunks)
+    {
+        string.append(chunk);
+    }
+    return HTString::create(std::move(string));
+}
+
+HTString* HTStringBuilder::takeString()
+{
+    HTString* string = nullptr;
+    if(_chunks.size() == 1)
+    {
+        string = HTString::create(std::move(_chunks[0]));
+    }
+    else
+    {
+        string = toString();
+    }
+
+    _chunks.clear();
+    _length = 0;
+    addChunk(0);
+    return string;
+}
+
+void HTStringBuilder::describeSelfTo(HTOutputSink& sink) const
+{
+    for(const auto& chunk: _chunks)
+    {
+        sink.append(chunk.data(), chunk.size());
+    }
+}
+
+NS_HT_END(Huta)
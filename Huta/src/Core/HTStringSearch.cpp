@@ -0,0 +1,248 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTStringSearch.h>
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HT_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+NS_HT_BEGIN(Huta)
+
+typedef ssize_t (*HTSearchFunction)(const char* haystack, size_t length, const char* needle, size_t needleLength);
+
+// First occurrence with memchr for the first byte, needleLength is at least 2
+static ssize_t findScalar(const char* haystack, size_t length, const char* needle, size_t needleLength)
+{
+    if(length < needleLength)
+    {
+        return -1;
+    }
+
+    const char* p = haystack;
+    const char* end = haystack + length - needleLength + 1;
+    while(p < end)
+    {
+        p = static_cast<const char*>(memchr(p, needle[0], end - p));
+        if(p == nullptr)
+        {
+            return -1;
+        }
+        if(memcmp(p + 1, needle + 1, needleLength - 1) == 0)
+        {
+            return p - haystack;
+        }
+        ++p;
+    }
+    return -1;
+}
+
+#if HT_SEARCH_X86
+// Blocks of 32 positions whose first and last needle bytes both match, the rest goes scalar
+__attribute__((target("avx2")))
+static ssize_t findAVX2(const char* haystack, size_t length, const char* needle, size_t needleLength)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needleLength - 1]);
+
+    size_t i = 0;
+
+    // Two blocks per step, most steps find no candidate in either
+    for(; i + needleLength - 1 + 64 <= length; i += 64)
+    {
+        const char* block = haystack + i;
+        const char* blockEnd = block + needleLength - 1;
+        __m256i low = _mm256_and_si256(_mm256_cmpeq_epi8(first, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block))),
+                                       _mm256_cmpeq_epi8(last, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blockEnd))));
+        __m256i high = _mm256_and_si256(_mm256_cmpeq_epi8(first, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32))),
+                                        _mm256_cmpeq_epi8(last, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blockEnd + 32))));
+        if(_mm256_testz_si256(_mm256_or_si256(low, high), _mm256_or_si256(low, high)))
+        {
+            continue;
+        }
+
+        uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(low)) | (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(high))) << 32);
+        while(mask != 0)
+        {
+            unsigned int bit = __builtin_ctzll(mask);
+            if(memcmp(block + bit + 1, needle + 1, needleLength - 2) == 0)
+            {
+                return static_cast<ssize_t>(i + bit);
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    for(; i + needleLength - 1 + 32 <= length; i += 32)
+    {
+        __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i));
+        __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i + needleLength - 1));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast))));
+        while(mask != 0)
+        {
+            unsigned int bit = __builtin_ctz(mask);
+            if(memcmp(haystack + i + bit + 1, needle + 1, needleLength - 2) == 0)
+            {
+                return static_cast<ssize_t>(i + bit);
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    ssize_t found = findScalar(haystack + i, length - i, needle, needleLength);
+    return found < 0 ? -1 : found + static_cast<ssize_t>(i);
+}
+
+__attribute__((target("sse2")))
+static ssize_t findSSE2(const char* haystack, size_t length, const char* needle, size_t needleLength)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needleLength - 1]);
+
+    size_t i = 0;
+    for(; i + needleLength - 1 + 16 <= length; i += 16)
+    {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + needleLength - 1));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast))));
+        while(mask != 0)
+        {
+            unsigned int bit = __builtin_ctz(mask);
+            if(memcmp(haystack + i + bit + 1, needle + 1, needleLength - 2) == 0)
+            {
+                return static_cast<ssize_t>(i + bit);
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    ssize_t found = findScalar(haystack + i, length - i, needle, needleLength);
+    return found < 0 ? -1 : found + static_cast<ssize_t>(i);
+}
+#endif
+
+static HTSearchFunction resolveFind()
+{
+#if HT_SEARCH_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return findAVX2;
+    }
+    if(__builtin_cpu_supports("sse2"))
+    {
+        return findSSE2;
+    }
+#endif
+    return findScalar;
+}
+
+// Needles of two or more bytes
+static ssize_t findLong(const char* haystack, size_t length, const char* needle, size_t needleLength)
+{
+    static const HTSearchFunction function = resolveFind();
+    return function(haystack, length, needle, needleLength);
+}
+
+ssize_t HTStringSearch::find(const HTStringView& haystack, const HTStringView& needle, size_t start)
+{
+    if(start > haystack.length || needle.length > haystack.length - start)
+    {
+        return -1;
+    }
+    if(needle.length == 0)
+    {
+        return static_cast<ssize_t>(start);
+    }
+
+    const char* from = haystack.data + start;
+    size_t length = haystack.length - start;
+    if(needle.length == 1)
+    {
+        const void* found = memchr(from, needle.data[0], length);
+        return found != nullptr ? static_cast<const char*>(found) - haystack.data : -1;
+    }
+
+    ssize_t found = findLong(from, length, needle.data, needle.length);
+    return found < 0 ? -1 : found + static_cast<ssize_t>(start);
+}
+
+size_t HTStringSearch::count(const HTStringView& haystack, const HTStringView& needle)
+{
+    if(needle.length == 0)
+    {
+        return 0;
+    }
+
+    size_t count = 0;
+    ssize_t found = find(haystack, needle, 0);
+    while(found >= 0)
+    {
+        ++count;
+        found = find(haystack, needle, static_cast<size_t>(found) + needle.length);
+    }
+    return count;
+}
+
+bool HTStringSearch::hasPrefix(const HTStringView& string, const HTStringView& prefix)
+{
+    return prefix.length <= string.length && memcmp(string.data, prefix.data, prefix.length) == 0;
+}
+
+bool HTStringSearch::hasSuffix(const HTStringView& string, const HTStringView& suffix)
+{
+    return suffix.length <= string.length && memcmp(string.data + string.length - suffix.length, suffix.data, suffix.length) == 0;
+}
+
+static unsigned char foldCase(unsigned char c)
+{
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+int HTStringSearch::compareIgnoringCase(const HTStringView& string, const HTStringView& other)
+{
+    size_t common = string.length < other.length ? string.length : other.length;
+    size_t i = 0;
+
+    // Skip the part that is equal byte for byte eight bytes at a time
+    while(i + 8 <= common && memcmp(string.data + i, other.data + i, 8) == 0)
+    {
+        i += 8;
+    }
+
+    for(; i < common; ++i)
+    {
+        unsigned char a = foldCase(static_cast<unsigned char>(string.data[i]));
+        unsigned char b = foldCase(static_cast<unsigned char>(other.data[i]));
+        if(a != b)
+        {
+            return a < b ? -1 : 1;
+        }
+    }
+    return string.length < other.length ? -1 : (string.length > other.length ? 1 : 0);
+}
+
+NS_HT_END(Huta)
@@ -0,0 +1,219 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTStringSlice.h>
+#include <Core/HTOutputSink.h>
+#include <Core/HTString.h>
+#include <Core/HTStringSearch.h>
+#include <Core/HTException.h>
+
+NS_HT_BEGIN(Huta)
+
+static bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+HTStringSlice* HTStringSlice::create(HTString* string)
+{
+    return createWithRange(string, 0, string->length());
+}
+
+HTStringSlice* HTStringSlice::createWithRange(HTString* string, size_t offset, size_t length)
+{
+    HTStringSlice* object = new HTStringSlice();
+    if(object && object->initWithRange(string, offset, length))
+    {
+        object->autorelease();
+    }
+    else
+    {
+        HT_SAFE_DELETE(object);
+    }
+    return object;
+}
+
+HTStringSlice::HTStringSlice()
+: _string(nullptr)
+, _offset(0)
+, _length(0)
+{
+
+}
+
+HTStringSlice::~HTStringSlice()
+{
+    HT_SAFE_RELEASE(_string);
+}
+
+bool HTStringSlice::initWithRange(HTString* string, size_t offset, size_t length)
+{
+    if(string == nullptr)
+    {
+        return false;
+    }
+    if(offset > string->length() || length > string->length() - offset)
+    {
+        throw HTException("Range out of bounds");
+    }
+
+    string->retain();
+    HT_SAFE_RELEASE(_string);
+    _string = string;
+    _offset = offset;
+    _length = length;
+    return true;
+}
+
+const char* HTStringSlice::getCharacters() const
+{
+    return _string->getCString() + _offset;
+}
+
+HTStringView HTStringSlice::getView() const
+{
+    return HTStringView(getCharacters(), _length);
+}
+
+char HTStringSlice::characterAtIndex(size_t index) const
+{
+    if(index >= _length)
+    {
+        throw HTException("Index out of range");
+    }
+    return getCharacters()[index];
+}
+
+HTStringSlice* HTStringSlice::sliceWithRange(size_t offset, size_t length) const
+{
+    if(offset > _length || length > _length - offset)
+    {
+        throw HTException("Range out of bounds");
+    }
+    return createWithRange(_string, _offset + offset, length);
+}
+
+HTStringSlice* HTStringSlice::trimmedSlice() const
+{
+    const char* characters = getCharacters();
+    size_t first = 0;
+    size_t last = _length;
+    while(first < last && isSpace(characters[first]))
+    {
+        ++first;
+    }
+    while(last > first && isSpace(characters[last - 1]))
+    {
+        --last;
+    }
+    return createWithRange(_string, _offset + first, last - first);
+}
+
+int HTStringSlice::compare(const char* string) const
+{
+    return getView().compare(HTStringView(string));
+}
+
+int HTStringSlice::compare(const HTStringView& view) const
+{
+    return getView().compare(view);
+}
+
+bool HTStringSlice::hasPrefix(const char* prefix) const
+{
+    return HTStringSearch::hasPrefix(getView(), HTStringView(prefix));
+}
+
+bool HTStringSlice::hasSuffix(const char* suffix) const
+{
+    return HTStringSearch::hasSuffix(getView(), HTStringView(suffix));
+}
+
+HTRange HTStringSlice::rangeOfString(const char* string, size_t start) const
+{
+    HTStringView needle(string);
+    ssize_t location = HTStringSearch::find(getView(), needle, start);
+    return location < 0 ? HTRange() : HTRange(location, needle.length);
+}
+
+int HTStringSlice::intValue() const
+{
+    return HTNumberParser::parseLeading<int>(getView(), "stoi");
+}
+
+unsigned int HTStringSlice::uintValue() const
+{
+    return HTNumberParser::parseLeading<unsigned int>(getView(), "stoul");
+}
+
+float HTStringSlice::floatValue() const
+{
+    return HTNumberParser::parseLeading<float>(getView(), "stof");
+}
+
+double HTStringSlice::doubleValue() const
+{
+    return HTNumberParser::parseLeading<double>(getView(), "stod");
+}
+
+bool HTStringSlice::boolValue() const
+{
+    HTStringView view = getView();
+    return view.length != 0 && view != HTStringView("0") && view != HTStringView("false");
+}
+
+std::string HTStringSlice::toStdString() const
+{
+    return getView().toStdString();
+}
+
+bool HTStringSlice::isEqual(const HTObject* object)
+{
+    const HTStringSlice* slice = dynamic_cast<const HTStringSlice*>(object);
+    if(slice != nullptr)
+    {
+        return getView() == slice->getView();
+    }
+    const HTString* string = dynamic_cast<const HTString*>(object);
+    if(string != nullptr)
+    {
+        return getView() == HTStringView(string->getCString(), string->length());
+    }
+    return false;
+}
+
+size_t HTStringSlice::hash() const
+{
+    return getView().hash();
+}
+
+HTString* HTStringSlice::toString() const
+{
+    return HTString::create(toStdString());
+}
+
+void HTStringSlice::describeSelfTo(HTOutputSink& sink) const
+{
+    sink.append(getView());
+}
+
+NS_HT_END(Huta)
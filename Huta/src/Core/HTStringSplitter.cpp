@@ -0,0 +1,93 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTStringSplitter.h>
+
+#include <cstring>
+
+NS_HT_BEGIN(Huta)
+
+HTStringSplitter::HTStringSplitter(const HTStringView& string, const HTStringView& delimiter)
+: _position(string.data)
+, _end(string.data + string.length)
+, _delimiter(delimiter)
+, _matched(false)
+, _done(false)
+{
+
+}
+
+bool HTStringSplitter::next(HTStringView& component)
+{
+    if(_done)
+    {
+        return false;
+    }
+
+    const char* match = findDelimiter();
+    if(match != nullptr)
+    {
+        component = HTStringView(_position, match - _position);
+        _position = match + _delimiter.length;
+        _matched = true;
+        return true;
+    }
+
+    // The rest is a component unless it is empty after a delimiter
+    _done = true;
+    if(!_matched || _position < _end)
+    {
+        component = HTStringView(_position, _end - _position);
+        return true;
+    }
+    return false;
+}
+
+// memchr scans a vector at a time for the first delimiter character, candidates are
+// then confirmed with memcmp
+const char* HTStringSplitter::findDelimiter() const
+{
+    size_t length = _delimiter.length;
+    if(length == 0)
+    {
+        return nullptr;
+    }
+
+    const char* position = _position;
+    while(static_cast<size_t>(_end - position) >= length)
+    {
+        const void* found = memchr(position, _delimiter.data[0], (_end - position) - length + 1);
+        if(found == nullptr)
+        {
+            return nullptr;
+        }
+        const char* candidate = static_cast<const char*>(found);
+        if(length == 1 || memcmp(candidate + 1, _delimiter.data + 1, length - 1) == 0)
+        {
+            return candidate;
+        }
+        position = candidate + 1;
+    }
+    return nullptr;
+}
+
+NS_HT_END(Huta)
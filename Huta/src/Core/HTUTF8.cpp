@@ -0,0 +1,359 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Trung Tran <trungtran0689@gmail.com>
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <Core/HTUTF8.h>
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+NS_HT_BEGIN(Huta)
+
+static const uint64_t kHighBits = 0x8080808080808080ULL;
+
+// Length of the ASCII run at the start of data, found a block at a time. The bytes after
+// the last full block are left to the caller
+static size_t asciiPrefixLength(const unsigned char* data, size_t length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    for(; i + 64 <= length; i += 64)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 32));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 48));
+        if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) != 0)
+        {
+            break;
+        }
+    }
+    for(; i + 16 <= length; i += 16)
+    {
+        if(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))) != 0)
+        {
+            break;
+        }
+    }
+#else
+    for(; i + 8 <= length; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        if((word & kHighBits) != 0)
+        {
+            break;
+        }
+    }
+#endif
+    return i;
+}
+
+// Decode the sequence at p. Return its length, 0 if it is not valid UTF-8
+static size_t decode(const unsigned char* p, const unsigned char* end, uint32_t& codePoint)
+{
+    unsigned char lead = p[0];
+    if(lead < 0x80)
+    {
+        codePoint = lead;
+        return 1;
+    }
+
+    size_t length = 0;
+    // Range of the second byte, narrower than 80..BF where it rules out overlong forms,
+    // surrogates or values above U+10FFFF
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if(lead >= 0xC2 && lead <= 0xDF)
+    {
+        length = 2;
+        codePoint = lead & 0x1F;
+    }
+    else if(lead >= 0xE0 && lead <= 0xEF)
+    {
+        length = 3;
+        codePoint = lead & 0x0F;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    }
+    else if(lead >= 0xF0 && lead <= 0xF4)
+    {
+        length = 4;
+        codePoint = lead & 0x07;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if(static_cast<size_t>(end - p) < length || p[1] < low || p[1] > high)
+    {
+        return 0;
+    }
+    codePoint = (codePoint << 6) | (p[1] & 0x3F);
+    for(size_t i = 2; i < length; ++i)
+    {
+        if((p[i] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+        codePoint = (codePoint << 6) | (p[i] & 0x3F);
+    }
+    return length;
+}
+
+static void encode(uint32_t codePoint, std::string& result)
+{
+    if(codePoint < 0x80)
+    {
+        result.push_back(static_cast<char>(codePoint));
+    }
+    else if(codePoint < 0x800)
+    {
+        result.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if(codePoint < 0x10000)
+    {
+        result.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+        result.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        result.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+bool HTUTF8::isASCII(const char* data, size_t length)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    for(size_t i = asciiPrefixLength(bytes, length); i < length; ++i)
+    {
+        if(bytes[i] >= 0x80)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HTUTF8::validate(const char* data, size_t length, size_t* errorOffset)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = bytes + length;
+    size_t i = 0;
+    while(i < length)
+    {
+        size_t ascii = asciiPrefixLength(bytes + i, length - i);
+        if(ascii > 0)
+        {
+            i += ascii;
+            continue;
+        }
+
+        // The next non ASCII byte is within one block
+        while(i < length && bytes[i] < 0x80)
+        {
+            ++i;
+        }
+        if(i == length)
+        {
+            break;
+        }
+
+        uint32_t codePoint = 0;
+        size_t sequence = decode(bytes + i, end, codePoint);
+        if(sequence == 0)
+        {
+            if(errorOffset != nullptr)
+            {
+                *errorOffset = i;
+            }
+            return false;
+        }
+        i += sequence;
+    }
+    return true;
+}
+
+size_t HTUTF8::countCodePoints(const char* data, size_t length)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    size_t count = 0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    // Bytes above -65 as signed values are the ones outside 80..BF
+    const __m128i continuation = _mm_set1_epi8(-65);
+    for(; i + 16 <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi8(block, continuation)));
+    }
+#endif
+
+    for(; i < length; ++i)
+    {
+        count += (bytes[i] & 0xC0) != 0x80 ? 1 : 0;
+    }
+    return count;
+}
+
+bool HTUTF8::toUTF16(const char* data, size_t length, std::u16string& result)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = bytes + length;
+    result.clear();
+    result.reserve(length);
+
+    size_t i = 0;
+    while(i < length)
+    {
+        size_t ascii = asciiPrefixLength(bytes + i, length - i);
+        if(ascii > 0)
+        {
+            // ASCII bytes widen to UTF-16 units unchanged
+            size_t start = result.size();
+            result.resize(start + ascii);
+            size_t j = 0;
+#if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            for(; j + 16 <= ascii; j += 16)
+            {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + j));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&result[start + j]), _mm_unpacklo_epi8(block, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&result[start + j + 8]), _mm_unpackhi_epi8(block, zero));
+            }
+#endif
+            for(; j < ascii; ++j)
+            {
+                result[start + j] = bytes[i + j];
+            }
+            i += ascii;
+            continue;
+        }
+
+        if(bytes[i] < 0x80)
+        {
+            result.push_back(bytes[i]);
+            ++i;
+            continue;
+        }
+
+        uint32_t codePoint = 0;
+        size_t sequence = decode(bytes + i, end, codePoint);
+        if(sequence == 0)
+        {
+            return false;
+        }
+        if(codePoint >= 0x10000)
+        {
+            codePoint -= 0x10000;
+            result.push_back(static_cast<char16_t>(0xD800 + (codePoint >> 10)));
+            result.push_back(static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF)));
+        }
+        else
+        {
+            result.push_back(static_cast<char16_t>(codePoint));
+        }
+        i += sequence;
+    }
+    return true;
+}
+
+bool HTUTF8::toUTF32(const char* data, size_t length, std::u32string& result)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = bytes + length;
+    result.clear();
+    result.reserve(length);
+
+    size_t i = 0;
+    while(i < length)
+    {
+        uint32_t codePoint = 0;
+        size_t sequence = decode(bytes + i, end, codePoint);
+        if(sequence == 0)
+        {
+            return false;
+        }
+        result.push_back(codePoint);
+        i += sequence;
+    }
+    return true;
+}
+
+bool HTUTF8::fromUTF16(const char16_t* data, size_t length, std::string& result)
+{
+    result.clear();
+    result.reserve(length);
+
+    for(size_t i = 0; i < length; ++i)
+    {
+        uint32_t unit = data[i];
+        if(unit < 0x80)
+        {
+            result.push_back(static_cast<char>(unit));
+            continue;
+        }
+        if(unit >= 0xD800 && unit <= 0xDFFF)
+        {
+            // A high surrogate followed by a low one is one code point
+            if(unit > 0xDBFF || i + 1 >= length || data[i + 1] < 0xDC00 || data[i + 1] > 0xDFFF)
+            {
+                return false;
+            }
+            unit = 0x10000 + ((unit - 0xD800) << 10) + (data[i + 1] - 0xDC00);
+            ++i;
+        }
+        encode(unit, result);
+    }
+    return true;
+}
+
+bool HTUTF8::fromUTF32(const char32_t* data, size_t length, std::string& result)
+{
+    result.clear();
+    result.reserve(length);
+
+    for(size_t i = 0; i < length; ++i)
+    {
+        uint32_t codePoint = data[i];
+        if(codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+        {
+            return false;
+        }
+        encode(codePoint, result);
+    }
+    return true;
+}
+
+NS_HT_END(Huta)
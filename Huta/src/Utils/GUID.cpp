@@ -21,6 +21,7 @@
 // THE SOFTWARE.
 
 #include <Utils/GUID.h>
+#include <Core/HTHash.h>
 
 #include <iomanip>
 #include <random>
@@ -146,6 +147,10 @@ namespace Huta {
         return !((*this) == other);
     }
 
+    size_t GUID::hash() const {
+        return static_cast<size_t>(HTHash::hashBytesSeeded(_bytes.data(), _bytes.size()));
+    }
+
 
     GUIDGenerator::GUIDGenerator() {
     }